@@ -0,0 +1,103 @@
+/*
+ * This file is part of Simple Ray Tracer.
+ * (https://github.com/ericwoude/ray-tracer)
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright © 2022 Eric van der Woude
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the “Software”), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef AABB_H
+#define AABB_H
+
+#include <cmath>
+#include <utility>
+
+#include "ray.h"
+#include "utility.h"
+#include "vec3.h"
+
+class aabb
+{
+   public:
+    aabb() : minimum(infinity, infinity, infinity),
+             maximum(-infinity, -infinity, -infinity)
+    {
+    }
+    aabb(const point3& a, const point3& b) : minimum(a), maximum(b) {}
+
+    point3 min() const { return minimum; }
+    point3 max() const { return maximum; }
+    point3 centroid() const { return 0.5 * (minimum + maximum); }
+
+    // Slab test; the box is hit if the ray overlaps all three slabs.
+    bool hit(const ray& r, double t_min, double t_max) const
+    {
+        for (int a = 0; a < 3; a++)
+        {
+            double inv_d = 1.0 / r.direction()[a];
+            double t0 = (minimum[a] - r.origin()[a]) * inv_d;
+            double t1 = (maximum[a] - r.origin()[a]) * inv_d;
+
+            if (inv_d < 0.0)
+                std::swap(t0, t1);
+
+            t_min = t0 > t_min ? t0 : t_min;
+            t_max = t1 < t_max ? t1 : t_max;
+
+            if (t_max < t_min)
+                return false;
+        }
+
+        return true;
+    }
+
+    void expand(const aabb& b)
+    {
+        for (int a = 0; a < 3; a++)
+        {
+            minimum[a] = fmin(minimum[a], b.minimum[a]);
+            maximum[a] = fmax(maximum[a], b.maximum[a]);
+        }
+    }
+
+    void expand(const point3& p) { expand(aabb(p, p)); }
+
+    int longest_axis() const
+    {
+        vec3 d = maximum - minimum;
+        if (d.x() > d.y() && d.x() > d.z())
+            return 0;
+
+        return d.y() > d.z() ? 1 : 2;
+    }
+
+    point3 minimum;
+    point3 maximum;
+};
+
+inline aabb surrounding_box(aabb a, const aabb& b)
+{
+    a.expand(b);
+    return a;
+}
+
+#endif  // AABB_H
@@ -0,0 +1,167 @@
+/*
+ * This file is part of Simple Ray Tracer.
+ * (https://github.com/ericwoude/ray-tracer)
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright © 2022 Eric van der Woude
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the “Software”), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef ANIMATION_H
+#define ANIMATION_H
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <future>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "color.h"
+#include "hittable_list.h"
+#include "render.h"
+#include "sphere.h"
+#include "thread_pool.h"
+#include "wide_bvh.h"
+
+// Bounces a sphere along amplitude, starting from its rest position.
+struct animation_track
+{
+    std::shared_ptr<sphere> object;
+    point3 rest;
+    vec3 amplitude;
+    double frequency;  // bounces per second
+    double phase;      // fraction of a bounce
+
+    point3 at(double time) const
+    {
+        return rest + fabs(sin(pi * (frequency * time + phase))) * amplitude;
+    }
+};
+
+/*
+ *  A world whose objects move over time. Only positions change between
+ *  frames, so the hierarchy is refit instead of rebuilt.
+ */
+class animated_scene
+{
+   public:
+    animated_scene(const hittable_list& w, std::vector<animation_track> t)
+        : world(w), tracks(std::move(t)), accel(world)
+    {
+    }
+
+    void update(double time)
+    {
+        for (const auto& t : tracks)
+            t.object->center = t.at(time);
+
+        accel.refit();
+    }
+
+    const hittable& accelerated() const { return accel; }
+
+   private:
+    hittable_list world;
+    std::vector<animation_track> tracks;
+    wide_bvh accel;
+};
+
+struct animation_settings
+{
+    int frames = 48;
+    double fps = 24;
+    double orbit = 15;  // degrees per second the camera turns around lookat
+    std::string output = "frame_";
+};
+
+// Rotates the camera position around the vertical axis through lookat.
+inline camera_params orbit(camera_params p, double degrees)
+{
+    double a = degrees_to_radians(degrees);
+    vec3 d = p.lookfrom - p.lookat;
+
+    p.lookfrom = p.lookat + vec3(d.x() * cos(a) + d.z() * sin(a), d.y(),
+                                 -d.x() * sin(a) + d.z() * cos(a));
+    return p;
+}
+
+inline void write_frame(const std::string& prefix, int frame,
+                        const framebuffer& fb)
+{
+    char number[16];
+    std::snprintf(number, sizeof(number), "%04d", frame);
+
+    std::ofstream out(prefix + number + ".ppm");
+    write_ppm(out, fb);
+}
+
+/*
+ *  Renders a sequence of frames to numbered PPM files. Two copies of the
+ *  scene are kept: while the pool renders frame N from one, the other is
+ *  moved to the time of frame N + 1 and frame N - 1 is written to disk.
+ */
+inline void render_animation(
+    const std::function<animated_scene()>& make_scene,
+    const camera_params& view, const render_settings& s,
+    const animation_settings& a, thread_pool& pool)
+{
+    animated_scene scenes[2] = {make_scene(), make_scene()};
+    framebuffer previous;
+
+    scenes[0].update(0);
+
+    for (int f = 0; f < a.frames; f++)
+    {
+        auto start = std::chrono::steady_clock::now();
+        animated_scene& current = scenes[f % 2];
+        animated_scene& next = scenes[(f + 1) % 2];
+
+        auto side = std::async(std::launch::async, [&, f] {
+            if (f + 1 < a.frames)
+                next.update((f + 1) / a.fps);
+            if (f > 0)
+                write_frame(a.output, f - 1, previous);
+        });
+
+        render_settings frame_settings = s;
+        frame_settings.seed = hash_seed(s.seed, f);
+        camera cam = make_camera(orbit(view, a.orbit * f / a.fps), s);
+        framebuffer fb = render(cam, current.accelerated(), frame_settings,
+                                pool);
+
+        side.get();
+        previous = std::move(fb);
+
+        std::chrono::duration<double> elapsed =
+            std::chrono::steady_clock::now() - start;
+        std::cerr << "frame " << f << " took " << elapsed.count() << "s\n";
+    }
+
+    if (a.frames > 0)
+        write_frame(a.output, a.frames - 1, previous);
+}
+
+#endif  // ANIMATION_H
@@ -0,0 +1,243 @@
+/*
+ * This file is part of Simple Ray Tracer.
+ * (https://github.com/ericwoude/ray-tracer)
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright © 2022 Eric van der Woude
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the “Software”), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef BVH_H
+#define BVH_H
+
+#include <algorithm>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+#include "aabb.h"
+#include "hittable.h"
+#include "hittable_list.h"
+#include "memory_ledger.h"
+
+/*
+ *  Binary bounding volume hierarchy stored as a flat array in depth-first
+ *  order: the left child of a node directly follows it, so every child has
+ *  a higher index than its parent. This lets refit() update the boxes of
+ *  moved objects in one backwards sweep without rebuilding the tree.
+ */
+class bvh : public hittable
+{
+   public:
+    bvh() {}
+    explicit bvh(const hittable_list& list) : primitives(list.objects)
+    {
+        if (!primitives.empty())
+            build(0, primitives.size());
+
+        charge = memory_charge(
+            memory_category::acceleration,
+            nodes.capacity() * sizeof(node) +
+                primitives.capacity() * sizeof(primitives[0]));
+    }
+
+    virtual bool hit(const ray& r, double t_min, double t_max,
+                     hit_record& rec) const override
+    {
+        if (nodes.empty())
+            return false;
+
+        int stack[64];
+        int top = 0;
+        bool hit = false;
+        double closest = t_max;
+        stack[top++] = 0;
+
+        while (top > 0)
+        {
+            const node& n = nodes[stack[--top]];
+            if (!n.box.hit(r, t_min, closest))
+                continue;
+
+            if (n.count > 0)
+            {
+                for (int i = n.start; i < n.start + n.count; i++)
+                {
+                    if (primitives[i]->hit(r, t_min, closest, rec))
+                    {
+                        hit = true;
+                        closest = rec.t;
+                    }
+                }
+                continue;
+            }
+
+            // Visit the child on the side the ray comes from first.
+            int left = &n - nodes.data() + 1;
+            if (r.direction()[n.axis] < 0)
+            {
+                stack[top++] = left;
+                stack[top++] = n.right;
+            }
+            else
+            {
+                stack[top++] = n.right;
+                stack[top++] = left;
+            }
+        }
+
+        return hit;
+    }
+
+    virtual bool bounding_box(aabb& output_box) const override
+    {
+        if (nodes.empty())
+            return false;
+
+        output_box = nodes[0].box;
+        return true;
+    }
+
+    // Calls f with every object whose leaf box the ray overlaps.
+    template <typename F>
+    void overlapping(const ray& r, double t_min, double t_max, F f) const
+    {
+        if (nodes.empty())
+            return;
+
+        int stack[64];
+        int top = 0;
+        stack[top++] = 0;
+
+        while (top > 0)
+        {
+            const node& n = nodes[stack[--top]];
+            if (!n.box.hit(r, t_min, t_max))
+                continue;
+
+            if (n.count > 0)
+            {
+                for (int i = n.start; i < n.start + n.count; i++)
+                    f(*primitives[i]);
+                continue;
+            }
+
+            stack[top++] = n.right;
+            stack[top++] = &n - nodes.data() + 1;
+        }
+    }
+
+    // Recomputes all boxes after objects moved; the topology is kept.
+    void refit()
+    {
+        for (int i = static_cast<int>(nodes.size()) - 1; i >= 0; i--)
+        {
+            node& n = nodes[i];
+
+            if (n.count > 0)
+                n.box = leaf_box(n.start, n.start + n.count);
+            else
+                n.box = surrounding_box(nodes[i + 1].box, nodes[n.right].box);
+        }
+    }
+
+    size_t node_count() const { return nodes.size(); }
+
+    virtual void footprint(scene_footprint& f) const override
+    {
+        for (const auto& p : primitives)
+            p->footprint(f);
+    }
+
+   private:
+    friend class wide_bvh;
+
+    struct node
+    {
+        aabb box;
+        int start;  // first primitive of a leaf
+        int count;  // amount of primitives, zero for interior nodes
+        int right;  // index of the right child of an interior node
+        int axis;   // split axis of an interior node
+    };
+
+    static const int leaf_size = 2;
+
+    aabb object_box(int i) const
+    {
+        aabb box;
+        if (!primitives[i]->bounding_box(box))
+            throw std::runtime_error("bvh: object without a bounding box");
+
+        return box;
+    }
+
+    aabb leaf_box(int start, int end) const
+    {
+        aabb box;
+        for (int i = start; i < end; i++)
+            box.expand(object_box(i));
+
+        return box;
+    }
+
+    // Splits at the median centroid along the longest centroid extent.
+    int build(int start, int end)
+    {
+        int index = nodes.size();
+        nodes.push_back({leaf_box(start, end), start, end - start, 0, 0});
+
+        if (end - start <= leaf_size)
+            return index;
+
+        aabb centroids;
+        for (int i = start; i < end; i++)
+            centroids.expand(object_box(i).centroid());
+
+        int axis = centroids.longest_axis();
+        int mid = start + (end - start) / 2;
+        std::nth_element(
+            primitives.begin() + start, primitives.begin() + mid,
+            primitives.begin() + end,
+            [axis](const std::shared_ptr<hittable>& a,
+                   const std::shared_ptr<hittable>& b) {
+                aabb box_a, box_b;
+                a->bounding_box(box_a);
+                b->bounding_box(box_b);
+                return box_a.centroid()[axis] < box_b.centroid()[axis];
+            });
+
+        build(start, mid);
+        int right = build(mid, end);
+
+        nodes[index].count = 0;
+        nodes[index].axis = axis;
+        nodes[index].right = right;
+
+        return index;
+    }
+
+    std::vector<node> nodes;
+    std::vector<std::shared_ptr<hittable>> primitives;
+    memory_charge charge;
+};
+
+#endif  // BVH_H
@@ -59,10 +59,16 @@ class camera
         vec3 rd = lens_radius * random_in_unit_disk();
         vec3 offset = u * rd.x() + v * rd.y();
 
-        return ray(origin + offset, lower_left + s * horizontal + t * vertical -
-                                        origin - offset);
+        ray r(origin + offset,
+              lower_left + s * horizontal + t * vertical - origin - offset);
+        r.spread = pixel_spread;
+
+        return r;
     }
 
+    // Angle subtended by one pixel, used to size texture lookups.
+    double pixel_spread = 0;
+
    private:
     point3 origin;
     point3 lower_left;
@@ -0,0 +1,134 @@
+/*
+ * This file is part of Simple Ray Tracer.
+ * (https://github.com/ericwoude/ray-tracer)
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright © 2022 Eric van der Woude
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the “Software”), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+
+#include "framebuffer.h"
+#include "render.h"
+
+/*
+ *  Checkpoints hold the per-pixel sums and sample counts of a progressive
+ *  render in scanline order. Every pass is seeded from the frame seed and
+ *  the pass index, so the seed and the amount of finished passes fully
+ *  describe the generator state and a resumed render continues exactly
+ *  where it stopped.
+ */
+
+struct checkpoint_header
+{
+    char magic[8];
+    int32_t width;
+    int32_t height;
+    int32_t pass_samples;
+    int32_t passes;
+    uint64_t seed;
+    camera_params view;
+};
+
+const char checkpoint_magic[8] = "RTCKPT2";
+
+// Writes to a temporary file first, so a kill mid-write keeps the old one.
+inline void save_checkpoint(const std::string& path, const framebuffer& fb,
+                            const render_settings& s, const camera_params& view,
+                            int pass_samples)
+{
+    checkpoint_header h;
+    std::memcpy(h.magic, checkpoint_magic, sizeof(h.magic));
+    h.width = fb.width();
+    h.height = fb.height();
+    h.pass_samples = pass_samples;
+    h.passes = fb.passes;
+    h.seed = s.seed;
+    h.view = view;
+
+    std::string tmp = path + ".tmp";
+    {
+        std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+        out.write(reinterpret_cast<const char*>(&h), sizeof(h));
+        fb.for_each_pixel([&](int x, int y) {
+            color c = fb.sum(x, y);
+            int32_t n = fb.samples(x, y);
+            out.write(reinterpret_cast<const char*>(c.e), sizeof(c.e));
+            out.write(reinterpret_cast<const char*>(&n), sizeof(n));
+        });
+
+        if (!out)
+            throw std::runtime_error("cannot write checkpoint " + tmp);
+    }
+
+    if (std::rename(tmp.c_str(), path.c_str()) != 0)
+        throw std::runtime_error("cannot replace checkpoint " + path);
+}
+
+/*
+ *  Loads a checkpoint into fb. Returns false if there is no checkpoint yet,
+ *  and throws if it belongs to a different frame.
+ */
+inline bool load_checkpoint(const std::string& path, const render_settings& s,
+                            const camera_params& view, int pass_samples,
+                            framebuffer& fb)
+{
+    std::ifstream in(path, std::ios::binary);
+    if (!in)
+        return false;
+
+    checkpoint_header h;
+    in.read(reinterpret_cast<char*>(&h), sizeof(h));
+
+    if (!in || std::memcmp(h.magic, checkpoint_magic, sizeof(h.magic)) != 0)
+        throw std::runtime_error(path + " is not a checkpoint");
+
+    if (h.width != s.width || h.height != s.height || h.seed != s.seed ||
+        h.pass_samples != pass_samples ||
+        std::memcmp(&h.view, &view, sizeof(view)) != 0)
+        throw std::runtime_error(path + " was made with different settings");
+
+    fb = framebuffer(s.width, s.height);
+    fb.passes = h.passes;
+    fb.for_each_pixel([&](int x, int y) {
+        color c;
+        int32_t n = 0;
+        in.read(reinterpret_cast<char*>(c.e), sizeof(c.e));
+        in.read(reinterpret_cast<char*>(&n), sizeof(n));
+        fb.set(x, y, c, n);
+    });
+
+    if (!in)
+        throw std::runtime_error(path + " is truncated");
+
+    return true;
+}
+
+#endif  // CHECKPOINT_H
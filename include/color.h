@@ -28,21 +28,26 @@
 #ifndef COLOR_H
 #define COLOR_H
 
+#include <algorithm>
 #include <iostream>
 
+#include "framebuffer.h"
 #include "utility.h"
 #include "vec3.h"
 
-void write_color(std::ostream &out, color pixel_color, int sample_amount)
+// Gamma corrected 8-bit value of a channel summed over sample_amount samples.
+int to_byte(double channel_sum, int sample_amount);
+
+void write_color(std::ostream &out, color pixel_color, int sample_amount);
+
+// Writes a plain PPM, dividing every pixel by its own sample count.
+inline void write_ppm(std::ostream &out, const framebuffer &fb)
 {
-    // Divide the color by the sample amount and correct using gamma 2
-    double r = sqrt(pixel_color.x() / sample_amount);
-    double g = sqrt(pixel_color.y() / sample_amount);
-    double b = sqrt(pixel_color.z() / sample_amount);
-
-    out << static_cast<int>(256 * clamp(r, 0.0, 0.999)) << " "
-        << static_cast<int>(256 * clamp(g, 0.0, 0.999)) << " "
-        << static_cast<int>(256 * clamp(b, 0.0, 0.999)) << "\n";
+    out << "P3\n" << fb.width() << " " << fb.height() << "\n255\n";
+
+    fb.for_each_pixel([&](int x, int y) {
+        write_color(out, fb.sum(x, y), std::max(fb.samples(x, y), 1));
+    });
 }
 
 #endif  // COLOR_H
\ No newline at end of file
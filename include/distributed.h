@@ -0,0 +1,252 @@
+/*
+ * This file is part of Simple Ray Tracer.
+ * (https://github.com/ericwoude/ray-tracer)
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright © 2022 Eric van der Woude
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the “Software”), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef DISTRIBUTED_H
+#define DISTRIBUTED_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "camera.h"
+#include "hittable.h"
+#include "net.h"
+#include "render.h"
+#include "thread_pool.h"
+
+/*
+ *  Coordinator/worker rendering over TCP. The coordinator splits the frame
+ *  into tiles and hands them to whichever worker asks next; workers render
+ *  them with the shared seed and send back the summed colors as doubles, so
+ *  the frame matches a local render exactly.
+ *
+ *  Messages are raw structs, so all machines must share the same ABI.
+ */
+
+struct job_header
+{
+    camera_params view;
+    int32_t width;
+    int32_t height;
+    int32_t sample_amount;
+    int32_t depth;
+    uint64_t seed;
+};
+
+// A negative id tells the worker that the frame is finished.
+struct tile_message
+{
+    int32_t id;
+    tile t;
+};
+
+class coordinator
+{
+   public:
+    coordinator(int port, const camera_params& view, const render_settings& s)
+        : listen_fd(listen_on(port)),
+          header{view, s.width, s.height, s.sample_amount, s.depth, s.seed},
+          tiles(make_tiles(s.width, s.height, job_tile_size)),
+          fb(s.width, s.height),
+          remaining(tiles.size())
+    {
+        for (size_t i = 0; i < tiles.size(); i++)
+            queue.push_back(i);
+    }
+
+    ~coordinator() { close(listen_fd); }
+
+    // Blocks until every tile has been rendered by some worker.
+    framebuffer run()
+    {
+        std::vector<std::thread> handlers;
+
+        while (true)
+        {
+            {
+                std::lock_guard<std::mutex> lock(m);
+                if (remaining == 0)
+                    break;
+            }
+
+            int fd = accept_within(listen_fd, 100);
+            if (fd >= 0)
+                handlers.emplace_back([this, fd] { serve_worker(fd); });
+        }
+
+        for (auto& h : handlers)
+            h.join();
+
+        return fb;
+    }
+
+   private:
+    // Multiple of tile_size, so workers seed the same tiles as a local render.
+    static const int job_tile_size = 4 * tile_size;
+
+    void serve_worker(int fd)
+    {
+        int id;
+
+        if (!send_all(fd, &header, sizeof(header)))
+        {
+            close(fd);
+            return;
+        }
+
+        while (next_tile(id))
+        {
+            const tile& t = tiles[id];
+            tile_message msg = {id, t};
+            std::vector<double> result((t.x1 - t.x0) * (t.y1 - t.y0) * 3);
+
+            if (!send_all(fd, &msg, sizeof(msg)) ||
+                !recv_all(fd, result.data(), result.size() * sizeof(double)))
+            {
+                // The worker died; give its tile to someone else.
+                requeue(id);
+                close(fd);
+                return;
+            }
+
+            finish_tile(id, result);
+        }
+
+        tile_message done = {-1, {0, 0, 0, 0}};
+        send_all(fd, &done, sizeof(done));
+        close(fd);
+    }
+
+    // Returns false once the whole frame is done.
+    bool next_tile(int& id)
+    {
+        std::unique_lock<std::mutex> lock(m);
+        cv.wait(lock, [this] { return !queue.empty() || remaining == 0; });
+        if (remaining == 0)
+            return false;
+
+        id = queue.front();
+        queue.pop_front();
+        return true;
+    }
+
+    void requeue(int id)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m);
+            queue.push_front(id);
+        }
+        cv.notify_one();
+    }
+
+    void finish_tile(int id, const std::vector<double>& result)
+    {
+        const tile& t = tiles[id];
+        size_t i = 0;
+
+        for (int y = t.y0; y < t.y1; y++)
+        {
+            for (int x = t.x0; x < t.x1; x++, i += 3)
+            {
+                fb.add(x, y, color(result[i], result[i + 1], result[i + 2]),
+                       header.sample_amount);
+            }
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(m);
+            remaining--;
+        }
+        cv.notify_all();
+    }
+
+    int listen_fd;
+    job_header header;
+    std::vector<tile> tiles;
+    framebuffer fb;
+    std::deque<int> queue;
+    size_t remaining;
+    std::mutex m;
+    std::condition_variable cv;
+};
+
+/*
+ *  Connects to a coordinator and renders tiles until told to stop. The world
+ *  is built from the coordinator's seed so every worker sees the same scene.
+ */
+inline void run_worker(
+    const std::string& host, int port,
+    const std::function<std::shared_ptr<hittable>(uint64_t)>& make_world,
+    thread_pool& pool)
+{
+    int fd = connect_to(host, port);
+    job_header header;
+
+    if (!recv_all(fd, &header, sizeof(header)))
+    {
+        close(fd);
+        throw std::runtime_error("coordinator closed the connection");
+    }
+
+    render_settings s;
+    s.width = header.width;
+    s.height = header.height;
+    s.sample_amount = header.sample_amount;
+    s.depth = header.depth;
+    s.seed = header.seed;
+
+    auto world = make_world(s.seed);
+    camera cam = make_camera(header.view, s);
+    tile_message msg;
+
+    while (recv_all(fd, &msg, sizeof(msg)) && msg.id >= 0)
+    {
+        framebuffer buffer(msg.t);
+        render_area(cam, *world, s, 0, pool, buffer);
+
+        std::vector<double> result;
+        buffer.for_each_pixel([&](int x, int y) {
+            color c = buffer.sum(x, y);
+            result.push_back(c.x());
+            result.push_back(c.y());
+            result.push_back(c.z());
+        });
+
+        if (!send_all(fd, result.data(), result.size() * sizeof(double)))
+            break;
+    }
+
+    close(fd);
+}
+
+#endif  // DISTRIBUTED_H
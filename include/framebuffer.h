@@ -0,0 +1,209 @@
+/*
+ * This file is part of Simple Ray Tracer.
+ * (https://github.com/ericwoude/ray-tracer)
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright © 2022 Eric van der Woude
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the “Software”), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef FRAMEBUFFER_H
+#define FRAMEBUFFER_H
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <utility>
+#include <vector>
+
+#include "memory_ledger.h"
+#include "vec3.h"
+
+// Rectangle of pixels [x0, x1) x [y0, y1), with y = 0 being the top row.
+struct tile
+{
+    int x0, y0;
+    int x1, y1;
+};
+
+// Tiles are aligned to a global grid of tile_size x tile_size pixels.
+const int tile_size = 16;
+
+// Interleaves the bits of x and y, giving the Z-order position of a tile.
+inline uint32_t morton_code(uint32_t x, uint32_t y)
+{
+    auto spread = [](uint32_t v) {
+        v &= 0xffff;
+        v = (v | (v << 8)) & 0x00ff00ff;
+        v = (v | (v << 4)) & 0x0f0f0f0f;
+        v = (v | (v << 2)) & 0x33333333;
+        v = (v | (v << 1)) & 0x55555555;
+        return v;
+    };
+
+    return spread(x) | (spread(y) << 1);
+}
+
+// The grid tiles covering area, clipped to it, in Morton order.
+inline std::vector<tile> morton_tiles(const tile& area)
+{
+    std::vector<std::pair<uint32_t, tile>> order;
+    int gx0 = area.x0 / tile_size;
+    int gy0 = area.y0 / tile_size;
+
+    for (int y = gy0 * tile_size; y < area.y1; y += tile_size)
+    {
+        for (int x = gx0 * tile_size; x < area.x1; x += tile_size)
+        {
+            tile t = {std::max(x, area.x0), std::max(y, area.y0),
+                      std::min(x + tile_size, area.x1),
+                      std::min(y + tile_size, area.y1)};
+
+            order.push_back(
+                {morton_code(x / tile_size - gx0, y / tile_size - gy0), t});
+        }
+    }
+
+    std::sort(order.begin(), order.end(), [](const auto& a, const auto& b) {
+        return a.first < b.first;
+    });
+
+    std::vector<tile> result;
+    for (const auto& o : order)
+        result.push_back(o.second);
+
+    return result;
+}
+
+/*
+ *  Per-pixel color sums and sample counts for an area of the frame. Pixels
+ *  are stored per grid tile in cache-line-aligned blocks, so a worker that
+ *  owns a tile never writes to a cache line of another tile. Scanline order
+ *  is only produced when resolving the image for output.
+ */
+class framebuffer
+{
+   public:
+    framebuffer() : framebuffer(tile{0, 0, 0, 0}) {}
+    framebuffer(int width, int height) : framebuffer(tile{0, 0, width, height})
+    {
+    }
+    explicit framebuffer(const tile& a)
+        : area(a),
+          gx0(a.x0 / tile_size),
+          gy0(a.y0 / tile_size),
+          columns(a.x1 > a.x0 ? (a.x1 - 1) / tile_size - gx0 + 1 : 0),
+          rows(a.y1 > a.y0 ? (a.y1 - 1) / tile_size - gy0 + 1 : 0),
+          blocks(columns * rows),
+          charge(memory_category::framebuffer, blocks.size() * sizeof(block))
+    {
+    }
+
+    int width() const { return area.x1 - area.x0; }
+    int height() const { return area.y1 - area.y0; }
+
+    // Pixel (x, y) is given in frame coordinates.
+    void add(int x, int y, const color& c, int n)
+    {
+        block& b = block_of(x, y);
+        int i = (y % tile_size) * tile_size + x % tile_size;
+        b.sum[i] += c;
+        b.samples[i] += n;
+    }
+
+    void set(int x, int y, const color& c, int n)
+    {
+        block& b = block_of(x, y);
+        int i = (y % tile_size) * tile_size + x % tile_size;
+        b.sum[i] = c;
+        b.samples[i] = n;
+    }
+
+    color sum(int x, int y) const
+    {
+        return block_of(x, y).sum[(y % tile_size) * tile_size + x % tile_size];
+    }
+
+    int samples(int x, int y) const
+    {
+        return block_of(x, y)
+            .samples[(y % tile_size) * tile_size + x % tile_size];
+    }
+
+    int min_samples() const
+    {
+        int n = std::numeric_limits<int>::max();
+        for_each_pixel([&](int x, int y) { n = std::min(n, samples(x, y)); });
+
+        return width() * height() > 0 ? n : 0;
+    }
+
+    int max_samples() const
+    {
+        int n = 0;
+        for_each_pixel([&](int x, int y) { n = std::max(n, samples(x, y)); });
+
+        return n;
+    }
+
+    // Visits every pixel of the area in scanline order.
+    template <typename F>
+    void for_each_pixel(F f) const
+    {
+        for (int y = area.y0; y < area.y1; y++)
+        {
+            for (int x = area.x0; x < area.x1; x++)
+                f(x, y);
+        }
+    }
+
+    // The grid tiles covering the area, clipped to it, in Morton order.
+    std::vector<tile> tiles() const { return morton_tiles(area); }
+
+    tile area;
+
+    // Amount of completed progressive passes.
+    int passes = 0;
+
+   private:
+    struct alignas(64) block
+    {
+        color sum[tile_size * tile_size];
+        int samples[tile_size * tile_size] = {};
+    };
+
+    block& block_of(int x, int y)
+    {
+        return blocks[(y / tile_size - gy0) * columns + (x / tile_size - gx0)];
+    }
+
+    const block& block_of(int x, int y) const
+    {
+        return blocks[(y / tile_size - gy0) * columns + (x / tile_size - gx0)];
+    }
+
+    int gx0, gy0;
+    int columns, rows;
+    std::vector<block> blocks;
+    memory_charge charge;
+};
+
+#endif  // FRAMEBUFFER_H
@@ -28,9 +28,14 @@
 #ifndef HITTABLE_H
 #define HITTABLE_H
 
+#include <memory>
+#include <vector>
+
+#include "aabb.h"
 #include "ray.h"
 
 class material;
+struct scene_footprint;
 
 struct hit_record
 {
@@ -39,6 +44,8 @@ struct hit_record
     std::shared_ptr<material> mat_ptr;
     double t;
     bool front;
+    double u = 0, v = 0;       // texture coordinates
+    double uv_footprint = 0;   // width of the ray cone in texture space
 
     inline void set_face_normal(const ray& r, const vec3& outward_normal)
     {
@@ -52,5 +59,26 @@ class hittable
    public:
     virtual bool hit(const ray& r, double t_min, double t_max,
                      hit_record& rec) const = 0;
+
+    // Returns false for objects without bounds.
+    virtual bool bounding_box(aabb& output_box) const = 0;
+
+    /*
+     *  Intersects a batch of rays, setting hits[i] and recs[i] for each ray.
+     *  Objects whose data is expensive to reach override this to fetch it
+     *  once for all rays that need it.
+     */
+    virtual void hit_batch(const std::vector<ray>& rays, double t_min,
+                           double t_max, std::vector<hit_record>& recs,
+                           std::vector<char>& hits) const
+    {
+        for (size_t i = 0; i < rays.size(); i++)
+            hits[i] = hit(rays[i], t_min, t_max, recs[i]);
+    }
+
+    // Adds the bytes of the object and of what it refers to. Structures
+    // that register themselves with the memory ledger only pass the walk
+    // on to their contents.
+    virtual void footprint(scene_footprint& f) const {}
 };
 #endif  // HITTABLE_H
\ No newline at end of file
@@ -44,28 +44,13 @@ class hittable_list : public hittable
 
     virtual bool hit(const ray& r, double t_min, double t_max,
                      hit_record& rec) const override;
+    virtual bool bounding_box(aabb& output_box) const override;
+    virtual void hit_batch(const std::vector<ray>& rays, double t_min,
+                           double t_max, std::vector<hit_record>& recs,
+                           std::vector<char>& hits) const override;
+    virtual void footprint(scene_footprint& f) const override;
 
     std::vector<std::shared_ptr<hittable>> objects;
 };
 
-bool hittable_list::hit(const ray& r, double t_min, double t_max,
-                        hit_record& rec) const
-{
-    hit_record tmp;
-    bool hit = false;
-    double closest = t_max;
-
-    for (const auto& o : objects)
-    {
-        if (o->hit(r, t_min, closest, tmp))
-        {
-            hit = true;
-            closest = tmp.t;
-            rec = tmp;
-        }
-    }
-
-    return hit;
-}
-
 #endif  // HITTABLE_LIST_H
\ No newline at end of file
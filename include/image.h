@@ -0,0 +1,60 @@
+/*
+ * This file is part of Simple Ray Tracer.
+ * (https://github.com/ericwoude/ray-tracer)
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright © 2022 Eric van der Woude
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the “Software”), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef IMAGE_H
+#define IMAGE_H
+
+#include <iostream>
+#include <vector>
+
+#include "framebuffer.h"
+
+// 8-bit RGB image in scanline order, top row first.
+struct image
+{
+    int width = 0;
+    int height = 0;
+    std::vector<unsigned char> rgb;
+};
+
+// Reads a plain (P3) or binary (P6) PPM with a maximum value of 255.
+image read_ppm(std::istream &in);
+
+void write_ppm(std::ostream &out, const image &img);
+
+// Converts a framebuffer the same way write_ppm does.
+image to_image(const framebuffer &fb);
+
+// Copies src into dst with its top left corner at (x, y), clipped to dst.
+void paste(image &dst, const image &src, int x, int y);
+
+// Root mean square difference of two images of the same size, in 8-bit
+// levels. With a radius, both are first averaged over squares of
+// (2 radius + 1)^2 pixels, which discounts noise the eye averages away.
+double rms_difference(const image &a, const image &b, int radius = 0);
+
+#endif  // IMAGE_H
@@ -0,0 +1,127 @@
+/*
+ * This file is part of Simple Ray Tracer.
+ * (https://github.com/ericwoude/ray-tracer)
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright © 2022 Eric van der Woude
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the “Software”), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef LRU_CACHE_H
+#define LRU_CACHE_H
+
+#include <algorithm>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+#include "memory_ledger.h"
+
+/*
+ *  Thread-safe least-recently-used cache of immutable blocks with a byte
+ *  budget. Values in use stay alive through their shared_ptr after
+ *  eviction, so memory can exceed the budget by the blocks that threads are
+ *  holding at that moment.
+ */
+template <typename Key, typename Value>
+class lru_cache
+{
+   public:
+    // Resident blocks are registered with the memory ledger under c.
+    lru_cache(size_t budget_bytes, memory_category c)
+        : budget(budget_bytes), charge(c, 0)
+    {
+    }
+
+    lru_cache(const lru_cache&) = delete;
+    lru_cache& operator=(const lru_cache&) = delete;
+
+    /*
+     *  Returns the block for key, calling load on a miss. load runs outside
+     *  the lock, so slow reads do not stall other threads, and returns the
+     *  block together with its size in bytes.
+     */
+    template <typename Load>
+    std::shared_ptr<const Value> get(const Key& key, Load load)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m);
+            auto it = entries.find(key);
+            if (it != entries.end())
+            {
+                lru.splice(lru.begin(), lru, it->second.position);
+                hit_count++;
+                return it->second.value;
+            }
+        }
+
+        size_t size = 0;
+        std::shared_ptr<const Value> value = load(size);
+
+        std::lock_guard<std::mutex> lock(m);
+        auto it = entries.find(key);
+        if (it != entries.end())
+            return it->second.value;  // another thread loaded it meanwhile
+
+        load_count++;
+        lru.push_front(key);
+        entries[key] = {value, size, lru.begin()};
+        resident += size;
+
+        while (resident > budget && lru.size() > 1)
+        {
+            auto victim = entries.find(lru.back());
+            resident -= victim->second.size;
+            entries.erase(victim);
+            lru.pop_back();
+        }
+        peak = std::max(peak, resident);
+        charge.resize(resident);
+
+        return value;
+    }
+
+    size_t loads() const { return load_count; }
+    size_t hits() const { return hit_count; }
+    size_t peak_bytes() const { return peak; }
+
+   private:
+    struct entry
+    {
+        std::shared_ptr<const Value> value;
+        size_t size;
+        typename std::list<Key>::iterator position;
+    };
+
+    size_t budget;
+    std::mutex m;
+    std::list<Key> lru;
+    std::unordered_map<Key, entry> entries;
+    size_t resident = 0;
+    size_t peak = 0;
+    size_t load_count = 0;
+    size_t hit_count = 0;
+    memory_charge charge;
+};
+
+#endif  // LRU_CACHE_H
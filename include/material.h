@@ -28,8 +28,14 @@
 #ifndef MATERIAL_H
 #define MATERIAL_H
 
+#include <functional>
+#include <memory>
+#include <unordered_map>
+
 #include "hittable.h"
+#include "memory_ledger.h"
 #include "ray.h"
+#include "texture.h"
 #include "utility.h"
 #include "vec3.h"
 
@@ -38,12 +44,25 @@ class material
    public:
     virtual bool scatter(const ray &in, const hit_record &rec,
                          color &attenuation, ray &scattered) const = 0;
+
+    // Whether other scatters exactly like this material, so that one of the
+    // two can be shared. hash() agrees with it.
+    virtual bool same_as(const material &other) const { return this == &other; }
+    virtual size_t hash() const { return std::hash<const void *>()(this); }
+
+    virtual void footprint(scene_footprint &f) const {}
+
+    // Whether scattering spreads over the whole hemisphere with a weight
+    // that does not depend on the direction, so that the surface can use
+    // incoming light cached around the hit.
+    virtual bool diffuse() const { return false; }
 };
 
 class lambertian : public material
 {
    public:
-    lambertian(const color &a) : albedo(a){};
+    lambertian(const color &a) : albedo(std::make_shared<solid_color>(a)){};
+    lambertian(std::shared_ptr<texture> a) : albedo(a){};
 
     virtual bool scatter(const ray &in, const hit_record &rec,
                          color &attenuation, ray &scattered) const override
@@ -54,30 +73,68 @@ class lambertian : public material
             scatter_dir = rec.n;
 
         scattered = ray(rec.p, scatter_dir);
-        attenuation = albedo;
+        attenuation = albedo->value(rec.u, rec.v, rec.uv_footprint);
 
         return true;
     }
 
-    color albedo;
+    virtual bool same_as(const material &other) const override
+    {
+        auto o = dynamic_cast<const lambertian *>(&other);
+        return o && o->albedo->same_as(*albedo);
+    }
+
+    virtual size_t hash() const override { return albedo->hash(); }
+
+    virtual bool diffuse() const override { return true; }
+
+    virtual void footprint(scene_footprint &f) const override
+    {
+        if (f.add(this, memory_category::materials,
+                  sizeof(*this) + shared_block_bytes))
+            albedo->footprint(f);
+    }
+
+    std::shared_ptr<texture> albedo;
 };
 
 class metal : public material
 {
    public:
-    metal(const color &a, double f) : albedo(a), fuzz(f < 1 ? f : 1){};
+    metal(const color &a, double f)
+        : albedo(std::make_shared<solid_color>(a)), fuzz(f < 1 ? f : 1){};
+    metal(std::shared_ptr<texture> a, double f)
+        : albedo(a), fuzz(f < 1 ? f : 1){};
 
     virtual bool scatter(const ray &in, const hit_record &rec,
                          color &attenuation, ray &scattered) const override
     {
         vec3 reflected = reflect(unit_vector(in.direction()), rec.n);
         scattered = ray(rec.p, reflected + fuzz * random_in_unit_sphere());
-        attenuation = albedo;
+        attenuation = albedo->value(rec.u, rec.v, rec.uv_footprint);
 
         return dot(scattered.direction(), rec.n) > 0;
     };
 
-    color albedo;
+    virtual bool same_as(const material &other) const override
+    {
+        auto o = dynamic_cast<const metal *>(&other);
+        return o && o->fuzz == fuzz && o->albedo->same_as(*albedo);
+    }
+
+    virtual size_t hash() const override
+    {
+        return hash_seed(albedo->hash(), std::hash<double>()(fuzz));
+    }
+
+    virtual void footprint(scene_footprint &f) const override
+    {
+        if (f.add(this, memory_category::materials,
+                  sizeof(*this) + shared_block_bytes))
+            albedo->footprint(f);
+    }
+
+    std::shared_ptr<texture> albedo;
     double fuzz;
 };
 
@@ -110,6 +167,23 @@ class dielectric : public material
         return true;
     }
 
+    virtual bool same_as(const material &other) const override
+    {
+        auto o = dynamic_cast<const dielectric *>(&other);
+        return o && o->refractive_index == refractive_index;
+    }
+
+    virtual size_t hash() const override
+    {
+        return std::hash<double>()(refractive_index);
+    }
+
+    virtual void footprint(scene_footprint &f) const override
+    {
+        f.add(this, memory_category::materials,
+              sizeof(*this) + shared_block_bytes);
+    }
+
     double refractive_index;
 
    private:
@@ -123,4 +197,30 @@ class dielectric : public material
     }
 };
 
+/*
+ *  Hands out one instance per distinct material, so that scenes which make
+ *  a material for every object keep only the ones that differ.
+ */
+class material_set
+{
+   public:
+    std::shared_ptr<material> intern(std::shared_ptr<material> m)
+    {
+        auto range = known.equal_range(m->hash());
+        for (auto it = range.first; it != range.second; ++it)
+        {
+            if (it->second->same_as(*m))
+                return it->second;
+        }
+
+        known.emplace(m->hash(), m);
+        return m;
+    }
+
+    size_t size() const { return known.size(); }
+
+   private:
+    std::unordered_multimap<size_t, std::shared_ptr<material>> known;
+};
+
 #endif  // MATERIAL_H
\ No newline at end of file
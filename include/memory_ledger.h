@@ -0,0 +1,173 @@
+/*
+ * This file is part of Simple Ray Tracer.
+ * (https://github.com/ericwoude/ray-tracer)
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright © 2022 Eric van der Woude
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the “Software”), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef MEMORY_LEDGER_H
+#define MEMORY_LEDGER_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <unordered_set>
+#include <utility>
+
+enum class memory_category
+{
+    primitives,
+    materials,
+    acceleration,
+    framebuffer,
+    scratch
+};
+
+const int memory_category_count = 5;
+
+const char* category_name(memory_category c);
+
+// Bookkeeping of a make_shared allocation beside the object: the vtable
+// pointer and the two reference counts of the control block.
+const size_t shared_block_bytes = 16;
+
+/*
+ *  Process-wide byte counts per category, with the highest value each one
+ *  and their sum have reached. Structures register what they hold through
+ *  memory_charge, so the counts follow them as they are built, copied and
+ *  freed.
+ */
+class memory_ledger
+{
+   public:
+    void change(memory_category c, int64_t bytes)
+    {
+        int i = static_cast<int>(c);
+        raise(high[i], now[i].fetch_add(bytes) + bytes);
+        raise(total_high, total.fetch_add(bytes) + bytes);
+    }
+
+    int64_t current(memory_category c) const
+    {
+        return now[static_cast<int>(c)];
+    }
+
+    int64_t peak(memory_category c) const
+    {
+        return high[static_cast<int>(c)];
+    }
+
+    int64_t current_total() const { return total; }
+    int64_t peak_total() const { return total_high; }
+
+   private:
+    static void raise(std::atomic<int64_t>& peak, int64_t value)
+    {
+        int64_t seen = peak;
+        while (value > seen && !peak.compare_exchange_weak(seen, value))
+        {
+        }
+    }
+
+    std::atomic<int64_t> now[memory_category_count] = {};
+    std::atomic<int64_t> high[memory_category_count] = {};
+    std::atomic<int64_t> total{0};
+    std::atomic<int64_t> total_high{0};
+};
+
+inline memory_ledger& memory_usage()
+{
+    static memory_ledger ledger;
+    return ledger;
+}
+
+// Writes the current and peak bytes of every category and the peak
+// resident size of the process.
+void write_memory_report(std::ostream& out, const memory_ledger& ledger);
+
+// Registers bytes with the ledger for as long as it lives. Copies register
+// the same amount again.
+class memory_charge
+{
+   public:
+    memory_charge() {}
+    memory_charge(memory_category c, size_t bytes) : category(c), bytes(0)
+    {
+        resize(bytes);
+    }
+
+    memory_charge(const memory_charge& o) : memory_charge(o.category, o.bytes)
+    {
+    }
+
+    memory_charge(memory_charge&& o) noexcept
+        : category(o.category), bytes(o.bytes)
+    {
+        o.bytes = 0;
+    }
+
+    memory_charge& operator=(memory_charge o)
+    {
+        std::swap(category, o.category);
+        std::swap(bytes, o.bytes);
+        return *this;
+    }
+
+    ~memory_charge() { resize(0); }
+
+    void resize(size_t new_bytes)
+    {
+        if (new_bytes != bytes)
+            memory_usage().change(category, static_cast<int64_t>(new_bytes) -
+                                                static_cast<int64_t>(bytes));
+        bytes = new_bytes;
+    }
+
+   private:
+    memory_category category = memory_category::scratch;
+    size_t bytes = 0;
+};
+
+/*
+ *  Bytes of the objects reachable from a scene, found by walking it.
+ *  Objects shared by several owners are counted once.
+ */
+struct scene_footprint
+{
+    size_t bytes[memory_category_count] = {};
+    std::unordered_set<const void*> seen;
+
+    // Counts the object at p, unless it was counted before; returns
+    // whether it was new.
+    bool add(const void* p, memory_category c, size_t size)
+    {
+        if (!seen.insert(p).second)
+            return false;
+
+        bytes[static_cast<int>(c)] += size;
+        return true;
+    }
+};
+
+#endif  // MEMORY_LEDGER_H
@@ -0,0 +1,143 @@
+/*
+ * This file is part of Simple Ray Tracer.
+ * (https://github.com/ericwoude/ray-tracer)
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright © 2022 Eric van der Woude
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the “Software”), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef NET_H
+#define NET_H
+
+#include <arpa/inet.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+// Minimal blocking TCP helpers; every socket is a plain file descriptor.
+
+inline int listen_on(int port)
+{
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0)
+        throw std::runtime_error("cannot create socket");
+
+    int yes = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(yes));
+
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    addr.sin_port = htons(port);
+
+    if (bind(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) < 0 ||
+        listen(fd, 64) < 0)
+    {
+        close(fd);
+        throw std::runtime_error("cannot listen on port " +
+                                 std::to_string(port));
+    }
+
+    return fd;
+}
+
+inline int connect_to(const std::string &host, int port)
+{
+    addrinfo hints{};
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_STREAM;
+
+    addrinfo *res = nullptr;
+    if (getaddrinfo(host.c_str(), std::to_string(port).c_str(), &hints,
+                    &res) != 0)
+        throw std::runtime_error("cannot resolve " + host);
+
+    int fd = socket(res->ai_family, res->ai_socktype, res->ai_protocol);
+    if (fd < 0 || connect(fd, res->ai_addr, res->ai_addrlen) < 0)
+    {
+        freeaddrinfo(res);
+        if (fd >= 0)
+            close(fd);
+        throw std::runtime_error("cannot connect to " + host + ":" +
+                                 std::to_string(port));
+    }
+    freeaddrinfo(res);
+
+    int yes = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &yes, sizeof(yes));
+
+    return fd;
+}
+
+// Waits at most timeout_ms for a connection; returns -1 if none arrived.
+inline int accept_within(int listen_fd, int timeout_ms)
+{
+    pollfd p = {listen_fd, POLLIN, 0};
+    if (poll(&p, 1, timeout_ms) <= 0)
+        return -1;
+
+    return accept(listen_fd, nullptr, nullptr);
+}
+
+// Both return false once the peer is gone, so callers can recover the work.
+inline bool send_all(int fd, const void *data, size_t size)
+{
+    const char *p = static_cast<const char *>(data);
+
+    while (size > 0)
+    {
+        ssize_t n = send(fd, p, size, MSG_NOSIGNAL);
+        if (n <= 0)
+            return false;
+
+        p += n;
+        size -= n;
+    }
+
+    return true;
+}
+
+inline bool recv_all(int fd, void *data, size_t size)
+{
+    char *p = static_cast<char *>(data);
+
+    while (size > 0)
+    {
+        ssize_t n = recv(fd, p, size, 0);
+        if (n <= 0)
+            return false;
+
+        p += n;
+        size -= n;
+    }
+
+    return true;
+}
+
+#endif  // NET_H
@@ -0,0 +1,358 @@
+/*
+ * This file is part of Simple Ray Tracer.
+ * (https://github.com/ericwoude/ray-tracer)
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright © 2022 Eric van der Woude
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the “Software”), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef PAGED_MESH_H
+#define PAGED_MESH_H
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "aabb.h"
+#include "bvh.h"
+#include "hittable.h"
+#include "hittable_list.h"
+#include "lru_cache.h"
+#include "material.h"
+#include "triangle.h"
+
+/*
+ *  Triangle meshes that live on disk in spatially coherent chunks. Only the
+ *  chunk table stays in memory; chunk payloads are paged in on demand
+ *  through a cache with a fixed byte budget.
+ *
+ *  File layout: a mesh_file_header, the chunk payloads (arrays of
+ *  packed_triangle) and finally the chunk table (chunk_count entries).
+ */
+
+struct packed_triangle
+{
+    point3 v0, v1, v2;
+    uint32_t material;  // index into the palette given to paged_mesh
+};
+
+struct chunk_entry
+{
+    point3 minimum, maximum;
+    uint64_t offset;
+    uint64_t count;
+};
+
+struct mesh_file_header
+{
+    char magic[8];
+    uint64_t table_offset;
+    uint64_t chunk_count;
+};
+
+const char mesh_file_magic[8] = "RTMESH1";
+
+/*
+ *  Streams triangles to a chunk file. Callers group spatially close
+ *  triangles by calling end_chunk() between groups, so no more than one
+ *  chunk is held in memory.
+ */
+class mesh_chunk_writer
+{
+   public:
+    explicit mesh_chunk_writer(const std::string& path)
+        : out(path, std::ios::binary | std::ios::trunc)
+    {
+        mesh_file_header h = {};
+        out.write(reinterpret_cast<const char*>(&h), sizeof(h));
+
+        if (!out)
+            throw std::runtime_error("cannot write " + path);
+    }
+
+    ~mesh_chunk_writer()
+    {
+        if (!finished)
+            finish();
+    }
+
+    void add(const packed_triangle& t)
+    {
+        current.push_back(t);
+        box.expand(t.v0);
+        box.expand(t.v1);
+        box.expand(t.v2);
+    }
+
+    void end_chunk()
+    {
+        if (current.empty())
+            return;
+
+        // Same padding as triangle::bounding_box, for flat chunks.
+        const vec3 pad(0.0001, 0.0001, 0.0001);
+        table.push_back({box.min() - pad, box.max() + pad,
+                         static_cast<uint64_t>(out.tellp()), current.size()});
+        out.write(reinterpret_cast<const char*>(current.data()),
+                  current.size() * sizeof(packed_triangle));
+
+        current.clear();
+        box = aabb();
+    }
+
+    void finish()
+    {
+        end_chunk();
+
+        mesh_file_header h;
+        std::memcpy(h.magic, mesh_file_magic, sizeof(h.magic));
+        h.table_offset = out.tellp();
+        h.chunk_count = table.size();
+
+        out.write(reinterpret_cast<const char*>(table.data()),
+                  table.size() * sizeof(chunk_entry));
+        out.seekp(0);
+        out.write(reinterpret_cast<const char*>(&h), sizeof(h));
+        out.close();
+        finished = true;
+    }
+
+   private:
+    std::ofstream out;
+    std::vector<packed_triangle> current;
+    std::vector<chunk_entry> table;
+    aabb box;
+    bool finished = false;
+};
+
+using chunk_data = std::vector<packed_triangle>;
+
+// Reads chunk payloads from the mesh file through an lru_cache.
+class chunk_cache
+{
+   public:
+    chunk_cache(const std::string& path, size_t budget_bytes)
+        : fd(open(path.c_str(), O_RDONLY)),
+          cache(budget_bytes, memory_category::primitives)
+    {
+        if (fd < 0)
+            throw std::runtime_error("cannot open " + path);
+    }
+
+    ~chunk_cache() { close(fd); }
+
+    chunk_cache(const chunk_cache&) = delete;
+    chunk_cache& operator=(const chunk_cache&) = delete;
+
+    std::shared_ptr<const chunk_data> get(int index, const chunk_entry& e)
+    {
+        return cache.get(index, [this, &e](size_t& size) {
+            // pread does not share a file position between threads.
+            auto data = std::make_shared<chunk_data>(e.count);
+            size = e.count * sizeof(packed_triangle);
+            if (pread(fd, data->data(), size, e.offset) !=
+                static_cast<ssize_t>(size))
+                throw std::runtime_error("cannot read mesh chunk");
+
+            return data;
+        });
+    }
+
+    size_t loads() const { return cache.loads(); }
+    size_t hits() const { return cache.hits(); }
+    size_t peak_bytes() const { return cache.peak_bytes(); }
+
+   private:
+    int fd;
+    lru_cache<int, chunk_data> cache;
+};
+
+class paged_mesh : public hittable
+{
+   public:
+    paged_mesh(const std::string& path, size_t cache_bytes,
+               std::vector<std::shared_ptr<material>> palette)
+        : cache(path, cache_bytes), materials(std::move(palette))
+    {
+        std::ifstream in(path, std::ios::binary);
+        mesh_file_header h;
+        in.read(reinterpret_cast<char*>(&h), sizeof(h));
+
+        if (!in || std::memcmp(h.magic, mesh_file_magic, sizeof(h.magic)))
+            throw std::runtime_error(path + " is not a mesh chunk file");
+
+        table.resize(h.chunk_count);
+        in.seekg(h.table_offset);
+        in.read(reinterpret_cast<char*>(table.data()),
+                table.size() * sizeof(chunk_entry));
+
+        if (!in)
+            throw std::runtime_error(path + " is truncated");
+
+        hittable_list proxies;
+        for (size_t i = 0; i < table.size(); i++)
+            proxies.add(std::make_shared<chunk_proxy>(*this, i));
+
+        top = bvh(proxies);
+    }
+
+    // The chunk proxies point back at the mesh.
+    paged_mesh(const paged_mesh&) = delete;
+    paged_mesh& operator=(const paged_mesh&) = delete;
+
+    virtual bool hit(const ray& r, double t_min, double t_max,
+                     hit_record& rec) const override
+    {
+        return top.hit(r, t_min, t_max, rec);
+    }
+
+    virtual bool bounding_box(aabb& output_box) const override
+    {
+        return top.bounding_box(output_box);
+    }
+
+    /*
+     *  Queues every ray on the chunks whose boxes it overlaps, then visits
+     *  each chunk once for all of its rays, so a batch loads a chunk at
+     *  most once instead of once per ray.
+     */
+    virtual void hit_batch(const std::vector<ray>& rays, double t_min,
+                           double t_max, std::vector<hit_record>& recs,
+                           std::vector<char>& hits) const override
+    {
+        std::map<int, std::vector<int>> queues;
+        std::vector<double> closest(rays.size(), t_max);
+
+        for (size_t i = 0; i < rays.size(); i++)
+        {
+            hits[i] = false;
+            top.overlapping(rays[i], t_min, t_max, [&](const hittable& h) {
+                queues[static_cast<const chunk_proxy&>(h).index].push_back(i);
+            });
+        }
+
+        for (const auto& q : queues)
+        {
+            auto data = cache.get(q.first, table[q.first]);
+
+            for (int i : q.second)
+            {
+                for (const auto& tri : *data)
+                {
+                    if (intersect(rays[i], tri, t_min, closest[i], recs[i]))
+                    {
+                        hits[i] = true;
+                        closest[i] = recs[i].t;
+                    }
+                }
+            }
+        }
+    }
+
+    size_t chunk_count() const { return table.size(); }
+
+    virtual void footprint(scene_footprint& f) const override
+    {
+        // Resident chunks are registered by the cache and the top level
+        // hierarchy by itself, which leaves the chunk table.
+        if (!f.add(this, memory_category::acceleration,
+                   table.capacity() * sizeof(chunk_entry)))
+            return;
+
+        for (const auto& m : materials)
+            m->footprint(f);
+    }
+
+    mutable chunk_cache cache;
+
+   private:
+    // Stand-in for a chunk in the top-level hierarchy.
+    class chunk_proxy : public hittable
+    {
+       public:
+        chunk_proxy(const paged_mesh& m, int i) : mesh(m), index(i) {}
+
+        virtual bool hit(const ray& r, double t_min, double t_max,
+                         hit_record& rec) const override
+        {
+            auto data = mesh.cache.get(index, mesh.table[index]);
+            bool hit = false;
+
+            for (const auto& tri : *data)
+            {
+                if (mesh.intersect(r, tri, t_min, t_max, rec))
+                {
+                    hit = true;
+                    t_max = rec.t;
+                }
+            }
+
+            return hit;
+        }
+
+        virtual bool bounding_box(aabb& output_box) const override
+        {
+            const chunk_entry& e = mesh.table[index];
+            output_box = aabb(e.minimum, e.maximum);
+            return true;
+        }
+
+        const paged_mesh& mesh;
+        int index;
+    };
+
+    bool intersect(const ray& r, const packed_triangle& tri, double t_min,
+                   double t_max, hit_record& rec) const
+    {
+        double t, b1, b2;
+        if (!triangle::intersect(r, tri.v0, tri.v1, tri.v2, t_min, t_max, t,
+                                 b1, b2))
+            return false;
+
+        rec.t = t;
+        rec.p = r.at(t);
+        rec.set_face_normal(r, unit_vector(cross(tri.v1 - tri.v0,
+                                                 tri.v2 - tri.v0)));
+        rec.mat_ptr = materials[tri.material];
+
+        // Packed triangles carry no texture coordinates.
+        rec.u = b1;
+        rec.v = b2;
+        rec.uv_footprint = 0;
+
+        return true;
+    }
+
+    std::vector<chunk_entry> table;
+    std::vector<std::shared_ptr<material>> materials;
+    bvh top;
+};
+
+#endif  // PAGED_MESH_H
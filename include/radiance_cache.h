@@ -0,0 +1,96 @@
+/*
+ * This file is part of Simple Ray Tracer.
+ * (https://github.com/ericwoude/ray-tracer)
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright © 2022 Eric van der Woude
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the “Software”), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef RADIANCE_CACHE_H
+#define RADIANCE_CACHE_H
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+
+#include "vec3.h"
+
+/*
+ *  Incoming light at diffuse surfaces, averaged per cell of a hashed
+ *  uniform grid. A cell is also split by the dominant axis of the surface
+ *  normal, so the two sides of a thin object do not share light. Cells are
+ *  spread over independently locked shards, which keeps concurrent lookups
+ *  and updates from waiting on each other.
+ *
+ *  Results depend on the order in which threads add estimates, so renders
+ *  with a cache are not reproducible bit for bit.
+ */
+class radiance_cache
+{
+   public:
+    // A cell answers lookups once it holds min_samples estimates. From
+    // max_samples on it keeps a running average instead of a plain sum, so
+    // that it follows the estimates of later passes, which rely on a fuller
+    // cache themselves.
+    explicit radiance_cache(double cell_size, int min_samples = 16,
+                            int max_samples = 1024);
+
+    radiance_cache(const radiance_cache&) = delete;
+    radiance_cache& operator=(const radiance_cache&) = delete;
+
+    // Average radiance arriving over the cosine-weighted hemisphere around
+    // n at p, if the cell has enough estimates yet.
+    bool lookup(const point3& p, const vec3& n, color& radiance) const;
+
+    void add(const point3& p, const vec3& n, const color& radiance);
+
+    size_t cells() const;
+    size_t lookups() const { return lookup_count; }
+    size_t hits() const { return hit_count; }
+
+   private:
+    struct cell
+    {
+        color sum;
+        int count = 0;
+    };
+
+    struct shard
+    {
+        mutable std::mutex m;
+        std::unordered_map<uint64_t, cell> cells;
+    };
+
+    static const int shard_count = 64;
+
+    uint64_t key(const point3& p, const vec3& n) const;
+
+    double inverse_size;
+    int min_samples;
+    int max_samples;
+    shard shards[shard_count];
+    mutable std::atomic<size_t> lookup_count{0};
+    mutable std::atomic<size_t> hit_count{0};
+};
+
+#endif  // RADIANCE_CACHE_H
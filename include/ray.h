@@ -28,14 +28,42 @@
 #ifndef RAY_H
 #define RAY_H
 
+#include <utility>
+
 #include "vec3.h"
 
+// Per-ray setup of the watertight triangle test (see triangle.cpp). It only
+// depends on the direction, so it is built once with the ray instead of for
+// every triangle the ray is tested against.
+struct ray_shear
+{
+    ray_shear() {}
+    explicit ray_shear(const vec3& d)
+    {
+        kz = fabs(d.x()) > fabs(d.y()) ? (fabs(d.x()) > fabs(d.z()) ? 0 : 2)
+                                       : (fabs(d.y()) > fabs(d.z()) ? 1 : 2);
+        kx = (kz + 1) % 3;
+        ky = (kx + 1) % 3;
+
+        // Keep the winding when looking down the negative axis.
+        if (d[kz] < 0)
+            std::swap(kx, ky);
+
+        sz = 1.0 / d[kz];
+        sx = d[kx] * sz;
+        sy = d[ky] * sz;
+    }
+
+    int kx, ky, kz;
+    double sx, sy, sz;
+};
+
 class ray
 {
    public:
     ray() {}
     ray(const vec3& origin, const vec3& direction)
-        : orig(origin), dir(direction)
+        : orig(origin), dir(direction), shear(direction)
     {
     }
 
@@ -44,8 +72,24 @@ class ray
 
     vec3 at(double t) const { return orig + t * dir; }
 
+    // Diameter of the ray's cone of influence after travelling to at(t).
+    double width_at(double t) const
+    {
+        return width + spread * t * dir.length();
+    }
+
+    // Continues the cone of the ray that hit at parameter t.
+    void follow(const ray& parent, double t)
+    {
+        width = parent.width_at(t);
+        spread = parent.spread;
+    }
+
     vec3 orig;
     vec3 dir;
+    ray_shear shear;
+    double width = 0;   // cone diameter at the origin
+    double spread = 0;  // growth of the diameter per unit of distance
 };
 
 #endif  // RAY_H
\ No newline at end of file
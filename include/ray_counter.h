@@ -0,0 +1,69 @@
+/*
+ * This file is part of Simple Ray Tracer.
+ * (https://github.com/ericwoude/ray-tracer)
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright © 2022 Eric van der Woude
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the “Software”), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef RAY_COUNTER_H
+#define RAY_COUNTER_H
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+#include "hittable.h"
+
+// Forwards to a world and counts the rays traced against it.
+class ray_counter : public hittable
+{
+   public:
+    explicit ray_counter(const hittable& w) : world(w) {}
+
+    virtual bool hit(const ray& r, double t_min, double t_max,
+                     hit_record& rec) const override
+    {
+        count.fetch_add(1, std::memory_order_relaxed);
+        return world.hit(r, t_min, t_max, rec);
+    }
+
+    virtual bool bounding_box(aabb& output_box) const override
+    {
+        return world.bounding_box(output_box);
+    }
+
+    virtual void hit_batch(const std::vector<ray>& rays, double t_min,
+                           double t_max, std::vector<hit_record>& recs,
+                           std::vector<char>& hits) const override
+    {
+        count.fetch_add(rays.size(), std::memory_order_relaxed);
+        world.hit_batch(rays, t_min, t_max, recs, hits);
+    }
+
+    mutable std::atomic<uint64_t> count{0};
+
+   private:
+    const hittable& world;
+};
+
+#endif  // RAY_COUNTER_H
@@ -0,0 +1,139 @@
+/*
+ * This file is part of Simple Ray Tracer.
+ * (https://github.com/ericwoude/ray-tracer)
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright © 2022 Eric van der Woude
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the “Software”), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef RAYTRACER_H
+#define RAYTRACER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include "framebuffer.h"
+#include "hittable.h"
+#include "hittable_list.h"
+#include "render.h"
+#include "thread_pool.h"
+#include "wide_bvh.h"
+
+/*
+ *  Embedding interface: build a scene, start renders that write into
+ *  caller-owned float buffers, and follow or cancel them while they run.
+ */
+
+class scene
+{
+   public:
+    void add(std::shared_ptr<hittable> object) { objects.add(object); }
+
+    // Builds the acceleration structure; objects added later need another
+    // build() before they are rendered.
+    void build();
+
+    const hittable& world() const;
+    size_t size() const { return objects.objects.size(); }
+
+   private:
+    hittable_list objects;
+    std::shared_ptr<wide_bvh> accel;
+};
+
+// The final scene of the book, built from seed.
+scene demo_scene(uint64_t seed);
+
+// Called from a worker thread once the pixels of a tile are in the buffer.
+using tile_callback = std::function<void(const tile&)>;
+
+class render_job
+{
+   public:
+    explicit render_job(int tiles) : total(tiles) {}
+
+    // Fraction of the tiles that have been rendered, from 0 to 1.
+    double progress() const
+    {
+        return total > 0 ? static_cast<double>(rendered) / total : 1.0;
+    }
+
+    bool done() const { return finished == total; }
+
+    // Tiles that have not started yet are dropped; the job then completes
+    // as soon as the running tiles are finished.
+    void cancel() { cancelled = true; }
+    bool was_cancelled() const { return cancelled; }
+
+    // Blocks until the job is done, then rethrows the first error a tile
+    // ran into, e.g. a texture that could not be read.
+    void wait();
+
+   private:
+    friend class renderer;
+
+    // Counts a tile as handled, whether it was rendered or dropped.
+    void finish_tile(bool was_rendered);
+    void fail(std::exception_ptr e);
+
+    const int total;
+    std::atomic<int> finished{0};
+    std::atomic<int> rendered{0};
+    std::atomic<bool> cancelled{false};
+    std::exception_ptr error;
+    std::mutex m;
+    std::condition_variable cv;
+};
+
+class renderer
+{
+   public:
+    // Renders on a private pool with the given amount of threads.
+    explicit renderer(
+        unsigned int threads = std::thread::hardware_concurrency());
+
+    // Renders on a pool owned by the caller.
+    explicit renderer(thread_pool& pool);
+
+    /*
+     *  Starts rendering in the background and returns right away. rgb must
+     *  hold s.width * s.height * 3 floats; every pixel receives its linear
+     *  color averaged over its samples, in scanline order from the top row.
+     *  The scene and buffer must outlive the job.
+     */
+    std::shared_ptr<render_job> render(const scene& world,
+                                       const camera_params& view,
+                                       const render_settings& s, float* rgb,
+                                       tile_callback on_tile = nullptr);
+
+   private:
+    std::unique_ptr<thread_pool> own_pool;
+    thread_pool* pool;
+};
+
+#endif  // RAYTRACER_H
@@ -0,0 +1,469 @@
+/*
+ * This file is part of Simple Ray Tracer.
+ * (https://github.com/ericwoude/ray-tracer)
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright © 2022 Eric van der Woude
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the “Software”), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef RENDER_H
+#define RENDER_H
+
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <vector>
+
+#include "camera.h"
+#include "framebuffer.h"
+#include "hittable.h"
+#include "material.h"
+#include "radiance_cache.h"
+#include "thread_pool.h"
+#include "utility.h"
+#include "vec3.h"
+
+struct render_settings
+{
+    int width = 400;
+    int height = 225;
+    int sample_amount = 500;
+    int depth = 30;
+    uint64_t seed = 0;
+
+    // Trace bounces breadth-first in batches, see render_tile_wavefront.
+    bool wavefront = false;
+
+    // End diffuse paths in this cache, see ray_color_cached. Only used by
+    // the depth-first loop.
+    radiance_cache* cache = nullptr;
+};
+
+// Everything needed to rebuild the camera once the image aspect is known.
+struct camera_params
+{
+    point3 lookfrom = point3(13, 2, 3);
+    point3 lookat = point3(0, 0, 0);
+    vec3 vup = vec3(0, 1, 0);
+    double vfov = 20;
+    double aperture = 0.1;
+    double focus_dist = 10.0;
+};
+
+inline camera make_camera(const camera_params& p, const render_settings& s)
+{
+    double aspect_ratio = static_cast<double>(s.width) / s.height;
+    camera cam(p.lookfrom, p.lookat, p.vup, p.vfov, aspect_ratio, p.aperture,
+               p.focus_dist);
+    cam.pixel_spread = 2.0 * tan(degrees_to_radians(p.vfov) / 2) /
+                       std::max(s.height - 1, 1);
+
+    return cam;
+}
+
+// Sky color seen by rays that leave the scene.
+inline color background(const ray& r)
+{
+    vec3 u_dir = unit_vector(r.direction());
+    double t = 0.5 * (u_dir.y() + 1.0);
+    return (1.0 - t) * color(1.0, 1.0, 1.0) + t * color(0.5, 0.7, 1.0);
+}
+
+inline color ray_color(const ray& r, const hittable& world, int depth)
+{
+    hit_record rec;
+
+    if (depth <= 0)
+        return color(0, 0, 0);
+
+    if (world.hit(r, 0.001, infinity, rec))
+    {
+        ray scattered;
+        color attenuation;
+
+        if (rec.mat_ptr->scatter(r, rec, attenuation, scattered))
+        {
+            scattered.follow(r, rec.t);
+            return attenuation * ray_color(scattered, world, depth - 1);
+        }
+
+        return color(0, 0, 0);
+    }
+
+    return background(r);
+}
+
+/*
+ *  ray_color for rendering with a radiance cache. The first diffuse surface
+ *  on a path is sampled as usual; at every later one the path ends in the
+ *  light cached around the hit, if the cache has enough estimates there.
+ *  Each diffuse hit that is traced further adds what its scattered ray
+ *  brought back, so the cache keeps improving while the render runs.
+ */
+inline color ray_color_cached(const ray& r, const hittable& world, int depth,
+                              radiance_cache& cache, int diffuse_hits)
+{
+    hit_record rec;
+
+    if (depth <= 0)
+        return color(0, 0, 0);
+
+    if (!world.hit(r, 0.001, infinity, rec))
+        return background(r);
+
+    ray scattered;
+    color attenuation;
+
+    if (!rec.mat_ptr->scatter(r, rec, attenuation, scattered))
+        return color(0, 0, 0);
+
+    scattered.follow(r, rec.t);
+
+    if (!rec.mat_ptr->diffuse())
+        return attenuation * ray_color_cached(scattered, world, depth - 1,
+                                              cache, diffuse_hits);
+
+    color incoming;
+    if (diffuse_hits > 0 && cache.lookup(rec.p, rec.n, incoming))
+        return attenuation * incoming;
+
+    incoming = ray_color_cached(scattered, world, depth - 1, cache,
+                                diffuse_hits + 1);
+    cache.add(rec.p, rec.n, incoming);
+
+    return attenuation * incoming;
+}
+
+inline std::vector<tile> make_tiles(int width, int height, int size)
+{
+    std::vector<tile> tiles;
+
+    for (int y = 0; y < height; y += size)
+    {
+        for (int x = 0; x < width; x += size)
+        {
+            tiles.push_back(
+                {x, y, std::min(x + size, width), std::min(y + size, height)});
+        }
+    }
+
+    return tiles;
+}
+
+/*
+ *  Same estimate as ray_color, but all paths of a tile advance one bounce at
+ *  a time and every bounce is a single hit_batch call. Worlds that page
+ *  geometry in can then load each piece once per bounce instead of once per
+ *  ray. Samples are traced in groups to bound the amount of live paths.
+ */
+inline void render_tile_wavefront(const camera& cam, const hittable& world,
+                                  const render_settings& s, const tile& t,
+                                  framebuffer& fb)
+{
+    struct path
+    {
+        ray r;
+        color throughput;
+        int pixel;
+    };
+
+    const int group = 16;
+    int w = t.x1 - t.x0;
+    std::vector<color> radiance(w * (t.y1 - t.y0));
+    std::vector<path> paths, next;
+    std::vector<ray> rays;
+    std::vector<hit_record> recs;
+    std::vector<char> hits;
+    memory_charge scratch(memory_category::scratch, 0);
+
+    for (int k0 = 0; k0 < s.sample_amount; k0 += group)
+    {
+        int k1 = std::min(k0 + group, s.sample_amount);
+        paths.clear();
+
+        for (int y = t.y0; y < t.y1; y++)
+        {
+            int row = (s.height - 1) - y;
+
+            for (int col = t.x0; col < t.x1; col++)
+            {
+                for (int k = k0; k < k1; k++)
+                {
+                    double u = (col + random_double()) / (s.width - 1);
+                    double v = (row + random_double()) / (s.height - 1);
+                    paths.push_back({cam.get_ray(u, v), color(1, 1, 1),
+                                     (y - t.y0) * w + (col - t.x0)});
+                }
+            }
+        }
+
+        for (int depth = s.depth; depth > 0 && !paths.empty(); depth--)
+        {
+            rays.clear();
+            for (const auto& p : paths)
+                rays.push_back(p.r);
+
+            recs.resize(rays.size());
+            hits.resize(rays.size());
+            world.hit_batch(rays, 0.001, infinity, recs, hits);
+
+            next.clear();
+            for (size_t i = 0; i < paths.size(); i++)
+            {
+                const path& p = paths[i];
+                ray scattered;
+                color attenuation;
+
+                if (!hits[i])
+                    radiance[p.pixel] += p.throughput * background(p.r);
+                else if (recs[i].mat_ptr->scatter(p.r, recs[i], attenuation,
+                                                  scattered))
+                {
+                    scattered.follow(p.r, recs[i].t);
+                    next.push_back(
+                        {scattered, p.throughput * attenuation, p.pixel});
+                }
+            }
+            std::swap(paths, next);
+
+            scratch.resize(radiance.capacity() * sizeof(color) +
+                           (paths.capacity() + next.capacity()) * sizeof(path) +
+                           rays.capacity() * sizeof(ray) +
+                           recs.capacity() * sizeof(hit_record) +
+                           hits.capacity());
+        }
+    }
+
+    for (int y = t.y0; y < t.y1; y++)
+    {
+        for (int col = t.x0; col < t.x1; col++)
+            fb.add(col, y, radiance[(y - t.y0) * w + (col - t.x0)],
+                   s.sample_amount);
+    }
+}
+
+/*
+ *  Accumulates sample_amount samples for every pixel of t into fb. The
+ *  generator is seeded from the pass and tile position, so a tile renders
+ *  the same no matter which thread or machine picks it up.
+ */
+inline void render_tile(const camera& cam, const hittable& world,
+                        const render_settings& s, const tile& t, int pass,
+                        framebuffer& fb)
+{
+    // Seed from the grid tile, which a cropped tile shares with the full one.
+    int gx = t.x0 - t.x0 % tile_size;
+    int gy = t.y0 - t.y0 % tile_size;
+    seed_random(hash_seed(hash_seed(s.seed, pass), gy * s.width + gx));
+
+    if (s.wavefront)
+    {
+        render_tile_wavefront(cam, world, s, t, fb);
+        return;
+    }
+
+    for (int y = t.y0; y < t.y1; y++)
+    {
+        int row = (s.height - 1) - y;
+
+        for (int col = t.x0; col < t.x1; col++)
+        {
+            color pixel_color(0, 0, 0);
+
+            for (int k = 0; k < s.sample_amount; k++)
+            {
+                double u = (col + random_double()) / (s.width - 1);
+                double v = (row + random_double()) / (s.height - 1);
+                ray r = cam.get_ray(u, v);
+
+                if (s.cache)
+                    pixel_color +=
+                        ray_color_cached(r, world, s.depth, *s.cache, 0);
+                else
+                    pixel_color += ray_color(r, world, s.depth);
+            }
+
+            fb.add(col, y, pixel_color, s.sample_amount);
+        }
+    }
+}
+
+using render_clock = std::chrono::steady_clock;
+
+/*
+ *  Renders fb.area of the frame by handing out one tile per job to the pool,
+ *  in Morton order so neighbouring tiles are traced close together in time.
+ *  Tiles are aligned to the global tile grid, so splitting a frame into
+ *  areas does not change the result. Tiles that have not started by the
+ *  deadline are skipped.
+ */
+inline void render_area(
+    const camera& cam, const hittable& world, const render_settings& s,
+    int pass, thread_pool& pool, framebuffer& fb,
+    render_clock::time_point deadline = render_clock::time_point::max())
+{
+    for (const auto& t : fb.tiles())
+    {
+        pool.submit([&cam, &world, &s, &fb, t, pass, deadline] {
+            if (render_clock::now() < deadline)
+                render_tile(cam, world, s, t, pass, fb);
+        });
+    }
+    pool.wait();
+}
+
+// Renders a full frame; the pool and world are owned by the caller so they
+// can be reused across frames.
+inline framebuffer render(const camera& cam, const hittable& world,
+                          const render_settings& s, thread_pool& pool)
+{
+    framebuffer fb(s.width, s.height);
+    render_area(cam, world, s, 0, pool, fb);
+    fb.passes = 1;
+
+    return fb;
+}
+
+/*
+ *  Fills s.cache before a render with a quick pass at a quarter of the
+ *  resolution, so that the first tiles already find light in the cache.
+ */
+inline void prime_radiance_cache(const camera_params& view,
+                                 const hittable& world,
+                                 const render_settings& s, int samples,
+                                 thread_pool& pool)
+{
+    render_settings quick = s;
+    quick.width = std::max(2, s.width / 4);
+    quick.height = std::max(2, s.height / 4);
+    quick.sample_amount = samples;
+    quick.seed = hash_seed(s.seed, 1);  // independent of the real passes
+    quick.wavefront = false;
+
+    render(make_camera(view, quick), world, quick, pool);
+}
+
+// One camera and resolution of a batch.
+struct view_job
+{
+    camera_params view;
+    render_settings settings;
+};
+
+/*
+ *  Renders several views of the same world. The tiles of all views are
+ *  queued at once, so threads do not idle at the end of each view.
+ */
+inline std::vector<framebuffer> render_views(const hittable& world,
+                                             const std::vector<view_job>& views,
+                                             thread_pool& pool)
+{
+    std::vector<camera> cams;
+    std::vector<framebuffer> fbs;
+
+    // Fill both first; the jobs keep references into them.
+    for (const auto& v : views)
+    {
+        cams.push_back(make_camera(v.view, v.settings));
+        fbs.emplace_back(v.settings.width, v.settings.height);
+    }
+
+    for (size_t i = 0; i < views.size(); i++)
+    {
+        for (const auto& t : fbs[i].tiles())
+        {
+            pool.submit([&cams, &views, &fbs, &world, i, t] {
+                render_tile(cams[i], world, views[i].settings, t, 0, fbs[i]);
+            });
+        }
+    }
+    pool.wait();
+
+    for (auto& fb : fbs)
+        fb.passes = 1;
+
+    return fbs;
+}
+
+/*
+ *  Continues fb in passes of pass_samples samples until every pixel has
+ *  s.sample_amount samples. after_pass runs between passes and can stop the
+ *  render early by returning false.
+ */
+inline void render_progressive(const camera& cam, const hittable& world,
+                               const render_settings& s, int pass_samples,
+                               thread_pool& pool, framebuffer& fb,
+                               const std::function<bool()>& after_pass)
+{
+    render_settings pass_settings = s;
+
+    while (fb.min_samples() < s.sample_amount)
+    {
+        pass_settings.sample_amount =
+            std::min(pass_samples, s.sample_amount - fb.min_samples());
+        render_area(cam, world, pass_settings, fb.passes, pool, fb);
+        fb.passes++;
+
+        if (!after_pass())
+            return;
+    }
+}
+
+/*
+ *  Renders progressive passes until the time budget runs out or every pixel
+ *  has s.sample_amount samples. The first pass of one sample always covers
+ *  the whole frame; later passes are sized from the measured time per
+ *  sample so they fit in the remaining budget, and pixels keep their own
+ *  sample counts when the last pass is cut off at the deadline.
+ */
+inline void render_within(const camera& cam, const hittable& world,
+                          const render_settings& s, double budget,
+                          int pass_samples, thread_pool& pool, framebuffer& fb)
+{
+    auto start = render_clock::now();
+    auto deadline =
+        start + std::chrono::duration_cast<render_clock::duration>(
+                    std::chrono::duration<double>(budget));
+    render_settings pass_settings = s;
+
+    pass_settings.sample_amount = 1;
+    render_area(cam, world, pass_settings, fb.passes++, pool, fb);
+    std::chrono::duration<double> per_sample = render_clock::now() - start;
+
+    while (fb.min_samples() < s.sample_amount)
+    {
+        auto pass_start = render_clock::now();
+        std::chrono::duration<double> left = deadline - pass_start;
+        int fits = static_cast<int>(left.count() / per_sample.count());
+        if (fits < 1)
+            break;
+
+        pass_settings.sample_amount = std::min(
+            {fits, pass_samples, s.sample_amount - fb.min_samples()});
+        render_area(cam, world, pass_settings, fb.passes++, pool, fb,
+                    deadline);
+        per_sample =
+            (render_clock::now() - pass_start) / pass_settings.sample_amount;
+    }
+}
+
+#endif  // RENDER_H
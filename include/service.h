@@ -0,0 +1,179 @@
+/*
+ * This file is part of Simple Ray Tracer.
+ * (https://github.com/ericwoude/ray-tracer)
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright © 2022 Eric van der Woude
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the “Software”), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef SERVICE_H
+#define SERVICE_H
+
+#include <iostream>
+#include <sstream>
+#include <string>
+
+#include "color.h"
+#include "hittable.h"
+#include "render.h"
+#include "thread_pool.h"
+
+/*
+ *  Long-lived render server speaking a line protocol. The world and thread
+ *  pool are set up once; each job only changes the view and settings.
+ *
+ *  Commands (one per line), each answered with "ok" or "error <reason>":
+ *    camera <fx> <fy> <fz> <ax> <ay> <az> <vfov> <aperture> <focus_dist>
+ *    size <width> <height>
+ *    samples <n>
+ *    depth <n>
+ *    crop <x0> <y0> <x1> <y1>   only render this rectangle; "crop off" resets
+ *    render          "ok" is followed by the image as a plain PPM
+ *    quit
+ */
+class render_service
+{
+   public:
+    render_service(const hittable& w, thread_pool& p,
+                   const render_settings& s = render_settings())
+        : world(w), pool(p), settings(s)
+    {
+    }
+
+    void run(std::istream& in, std::ostream& out)
+    {
+        std::string line;
+
+        while (std::getline(in, line))
+        {
+            std::istringstream args(line);
+            std::string cmd;
+            if (!(args >> cmd))
+                continue;
+
+            if (cmd == "quit")
+            {
+                out << "ok" << std::endl;
+                return;
+            }
+
+            std::string error = handle(cmd, args, out);
+            if (!error.empty())
+                out << "error " << error << std::endl;
+        }
+    }
+
+   private:
+    // Returns an empty string on success, otherwise the reason of failure.
+    std::string handle(const std::string& cmd, std::istringstream& args,
+                       std::ostream& out)
+    {
+        if (cmd == "camera")
+        {
+            camera_params p = view;
+            if (!(args >> p.lookfrom[0] >> p.lookfrom[1] >> p.lookfrom[2] >>
+                  p.lookat[0] >> p.lookat[1] >> p.lookat[2] >> p.vfov >>
+                  p.aperture >> p.focus_dist))
+                return "camera expects 9 numbers";
+
+            view = p;
+        }
+        else if (cmd == "size")
+        {
+            int w, h;
+            if (!(args >> w >> h) || w < 2 || h < 2)
+                return "size expects a width and height of at least 2";
+
+            settings.width = w;
+            settings.height = h;
+        }
+        else if (cmd == "samples")
+        {
+            int n;
+            if (!(args >> n) || n < 1)
+                return "samples expects a positive number";
+
+            settings.sample_amount = n;
+        }
+        else if (cmd == "depth")
+        {
+            int n;
+            if (!(args >> n) || n < 1)
+                return "depth expects a positive number";
+
+            settings.depth = n;
+        }
+        else if (cmd == "crop")
+        {
+            std::string off;
+            tile c;
+
+            if (args >> off && off == "off")
+                crop = {0, 0, 0, 0};
+            else
+            {
+                args.clear();
+                args.seekg(0);
+                args >> off;
+                if (!(args >> c.x0 >> c.y0 >> c.x1 >> c.y1) || c.x0 < 0 ||
+                    c.y0 < 0 || c.x1 <= c.x0 || c.y1 <= c.y0)
+                    return "crop expects x0 y0 x1 y1 or off";
+
+                crop = c;
+            }
+        }
+        else if (cmd == "render")
+        {
+            tile area = {0, 0, settings.width, settings.height};
+            if (crop.x1 > crop.x0)
+            {
+                if (crop.x1 > settings.width || crop.y1 > settings.height)
+                    return "crop lies outside the frame";
+                area = crop;
+            }
+
+            camera cam = make_camera(view, settings);
+            framebuffer fb(area);
+            render_area(cam, world, settings, 0, pool, fb);
+
+            out << "ok\n";
+            write_ppm(out, fb);
+            out.flush();
+            return "";
+        }
+        else
+        {
+            return "unknown command " + cmd;
+        }
+
+        out << "ok" << std::endl;
+        return "";
+    }
+
+    const hittable& world;
+    thread_pool& pool;
+    render_settings settings;
+    camera_params view;
+    tile crop = {0, 0, 0, 0};
+};
+
+#endif  // SERVICE_H
@@ -0,0 +1,210 @@
+/*
+ * This file is part of Simple Ray Tracer.
+ * (https://github.com/ericwoude/ray-tracer)
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright © 2022 Eric van der Woude
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the “Software”), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef TEXTURE_H
+#define TEXTURE_H
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "image.h"
+#include "lru_cache.h"
+#include "memory_ledger.h"
+#include "utility.h"
+#include "vec3.h"
+
+class texture
+{
+   public:
+    virtual ~texture() = default;
+
+    // Color at (u, v), averaged over a footprint of the given width in
+    // texture space.
+    virtual color value(double u, double v, double footprint) const = 0;
+
+    // Whether other gives the same colors everywhere, so that one of the
+    // two can be shared. hash() agrees with it.
+    virtual bool same_as(const texture& other) const { return this == &other; }
+    virtual size_t hash() const { return std::hash<const void*>()(this); }
+
+    virtual void footprint(scene_footprint& f) const {}
+};
+
+class solid_color : public texture
+{
+   public:
+    solid_color(const color& c) : c(c) {}
+
+    virtual color value(double u, double v, double footprint) const override
+    {
+        return c;
+    }
+
+    virtual bool same_as(const texture& other) const override
+    {
+        auto o = dynamic_cast<const solid_color*>(&other);
+        return o && o->c.x() == c.x() && o->c.y() == c.y() &&
+               o->c.z() == c.z();
+    }
+
+    virtual size_t hash() const override
+    {
+        std::hash<double> h;
+        return hash_seed(hash_seed(h(c.x()), h(c.y())), h(c.z()));
+    }
+
+    virtual void footprint(scene_footprint& f) const override
+    {
+        f.add(this, memory_category::materials,
+              sizeof(*this) + shared_block_bytes);
+    }
+
+    color c;
+};
+
+/*
+ *  Texture file layout: a header, one level record per mip level from full
+ *  size down to 1x1, then the tiles of every level in scanline order. Each
+ *  tile holds tile_size x tile_size gamma-2 RGB bytes, padded at the right
+ *  and bottom edges, so a texel is found without reading anything else.
+ */
+const char texture_file_magic[8] = "RTTEX01";
+const int texture_tile_size = 32;
+
+struct texture_file_header
+{
+    char magic[8];
+    int32_t width;
+    int32_t height;
+    int32_t levels;
+    int32_t tile_size;
+};
+
+struct texture_level
+{
+    int32_t width;
+    int32_t height;
+    int32_t tiles_x;
+    int32_t tiles_y;
+    uint64_t offset;
+};
+
+// Builds the mip chain of img with a box filter and writes it to path.
+void write_texture(const std::string& path, const image& img);
+
+/*
+ *  Tiles of any number of texture files behind one byte budget. Only the
+ *  tiles that lookups touch are read, so the resident size stays near the
+ *  budget however large the textures on disk are.
+ */
+class texture_cache
+{
+   public:
+    explicit texture_cache(size_t budget_bytes);
+    ~texture_cache();
+
+    texture_cache(const texture_cache&) = delete;
+    texture_cache& operator=(const texture_cache&) = delete;
+
+    // Opens a texture file and returns its id. Call before rendering
+    // starts; lookups may then run from any thread.
+    int open(const std::string& path);
+
+    const std::vector<texture_level>& levels(int id) const
+    {
+        return files[id].levels;
+    }
+
+    // Linear color of texel (x, y) of a level, wrapping around the edges.
+    color texel(int id, int level, int x, int y);
+
+    size_t loads() const { return cache.loads(); }
+    size_t hits() const { return cache.hits(); }
+    size_t peak_bytes() const { return cache.peak_bytes(); }
+
+   private:
+    using tile_data = std::vector<unsigned char>;
+
+    struct file
+    {
+        int fd;
+        std::vector<texture_level> levels;
+    };
+
+    std::shared_ptr<const tile_data> fetch(int id, int level, int tile);
+
+    std::vector<file> files;
+    lru_cache<uint64_t, tile_data> cache;
+    uint64_t serial;  // tells the per-thread memos of two caches apart
+};
+
+/*
+ *  Image texture repeated scale times across the unit square. The mip level
+ *  is picked from the footprint so that a lookup covers about one texel,
+ *  and neighbouring levels are blended (trilinear filtering).
+ */
+class image_texture : public texture
+{
+   public:
+    image_texture(std::shared_ptr<texture_cache> c, const std::string& path,
+                  double scale = 1)
+        : cache(c), id(c->open(path)), scale(scale)
+    {
+    }
+
+    virtual color value(double u, double v, double footprint) const override;
+
+    virtual bool same_as(const texture& other) const override
+    {
+        auto o = dynamic_cast<const image_texture*>(&other);
+        return o && o->cache == cache && o->id == id && o->scale == scale;
+    }
+
+    virtual size_t hash() const override
+    {
+        return hash_seed(id, std::hash<double>()(scale));
+    }
+
+    // Resident tiles are registered by the cache.
+    virtual void footprint(scene_footprint& f) const override
+    {
+        f.add(this, memory_category::materials,
+              sizeof(*this) + shared_block_bytes);
+    }
+
+   private:
+    color bilinear(int level, double u, double v) const;
+
+    std::shared_ptr<texture_cache> cache;
+    int id;
+    double scale;
+};
+
+#endif  // TEXTURE_H
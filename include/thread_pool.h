@@ -0,0 +1,145 @@
+/*
+ * This file is part of Simple Ray Tracer.
+ * (https://github.com/ericwoude/ray-tracer)
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright © 2022 Eric van der Woude
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the “Software”), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <utility>
+#include <vector>
+
+/*
+ *  A fixed set of worker threads that stay alive between renders, so jobs
+ *  only pay for queueing instead of thread creation.
+ */
+class thread_pool
+{
+   public:
+    explicit thread_pool(unsigned int n = std::thread::hardware_concurrency())
+    {
+        if (n == 0)
+            n = 1;
+
+        for (unsigned int i = 0; i < n; i++)
+            workers.emplace_back([this] { work(); });
+    }
+
+    ~thread_pool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m);
+            stopping = true;
+        }
+        job_cv.notify_all();
+
+        for (auto& t : workers)
+        {
+            if (t.joinable())
+                t.join();
+        }
+    }
+
+    thread_pool(const thread_pool&) = delete;
+    thread_pool& operator=(const thread_pool&) = delete;
+
+    void submit(std::function<void()> job)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m);
+            jobs.push(std::move(job));
+            pending++;
+        }
+        job_cv.notify_one();
+    }
+
+    // Blocks until every submitted job has finished, then rethrows the
+    // first exception a job threw since the last wait, if any.
+    void wait()
+    {
+        std::unique_lock<std::mutex> lock(m);
+        idle_cv.wait(lock, [this] { return pending == 0; });
+
+        if (error)
+            std::rethrow_exception(std::exchange(error, nullptr));
+    }
+
+    unsigned int size() const { return workers.size(); }
+
+   private:
+    void work()
+    {
+        while (true)
+        {
+            std::function<void()> job;
+            {
+                std::unique_lock<std::mutex> lock(m);
+                job_cv.wait(lock, [this] { return stopping || !jobs.empty(); });
+                if (stopping && jobs.empty())
+                    return;
+
+                job = std::move(jobs.front());
+                jobs.pop();
+            }
+
+            // An exception must not leave the thread, which would terminate
+            // the process; wait() hands it to the caller instead.
+            std::exception_ptr failure;
+            try
+            {
+                job();
+            }
+            catch (...)
+            {
+                failure = std::current_exception();
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(m);
+                if (failure && !error)
+                    error = failure;
+                pending--;
+            }
+            idle_cv.notify_all();
+        }
+    }
+
+    std::vector<std::thread> workers;
+    std::queue<std::function<void()>> jobs;
+    std::mutex m;
+    std::condition_variable job_cv;
+    std::condition_variable idle_cv;
+    size_t pending = 0;
+    bool stopping = false;
+    std::exception_ptr error;
+};
+
+#endif  // THREAD_POOL_H
@@ -38,55 +38,47 @@ class triangle : public hittable
    public:
     triangle() {}
     triangle(point3 t0, point3 t1, point3 t2, std::shared_ptr<material> m)
-        : v0(t0), v1(t1), v2(t2), mat_ptr(m){};
+        : triangle(t0, t1, t2, vec3(0, 0, 0), vec3(1, 0, 0), vec3(0, 1, 0), m)
+    {
+    }
+
+    // uv0, uv1 and uv2 are the texture coordinates of the vertices; only
+    // their x and y are used.
+    triangle(point3 t0, point3 t1, point3 t2, vec3 uv0, vec3 uv1, vec3 uv2,
+             std::shared_ptr<material> m)
+        : v0(t0),
+          v1(t1),
+          v2(t2),
+          normal(unit_vector(cross(t1 - t0, t2 - t0))),
+          uv{uv0, uv1, uv2},
+          mat_ptr(m)
+    {
+        // Texture-space length per unit of world length, from the ratio of
+        // the two areas.
+        double world_area = cross(t1 - t0, t2 - t0).length();
+        double uv_area = fabs(cross(uv1 - uv0, uv2 - uv0).z());
+        uv_scale = world_area > 0 ? sqrt(uv_area / world_area) : 0;
+    }
 
     virtual bool hit(const ray& r, double t_min, double t_max,
                      hit_record& rec) const override;
+    virtual bool bounding_box(aabb& output_box) const override;
+    virtual void footprint(scene_footprint& f) const override;
+
+    // Finds the distance t along r to triangle (v0, v1, v2), if it lies
+    // within [t_min, t_max], and the barycentric weights b1 and b2 of v1
+    // and v2 at the hit. Shared with meshes that store raw vertices.
+    static bool intersect(const ray& r, const point3& v0, const point3& v1,
+                          const point3& v2, double t_min, double t_max,
+                          double& t, double& b1, double& b2);
 
     point3 v0;
     point3 v1;
     point3 v2;
+    vec3 normal;  // unit face normal, fixed at construction
+    vec3 uv[3];
+    double uv_scale;
     std::shared_ptr<material> mat_ptr;
 };
 
-// Möller–Trumbore intersection algorithm
-bool triangle::hit(const ray& r, double t_min, double t_max,
-                   hit_record& rec) const
-{
-    double determinant, f, u, v;
-    vec3 h, s, q;
-
-    vec3 A = (r.origin() - v0) - (r.origin() - v2);
-    vec3 B = (r.origin() - v0) - (r.origin() - v1);
-
-    // Ray and triangle are parallel if the determinant nears zero
-    h = cross(r.direction(), B);
-    determinant = dot(A, h);
-    if (fabs(determinant) < epsilon)
-        return false;
-
-    f = 1.0 / determinant;
-    s = r.origin() - v0;
-    u = f * dot(s, h);
-    if (u < 0.0 || u > 1.0)
-        return false;
-
-    q = cross(s, A);
-    v = f * dot(r.direction(), q);
-    if (v < 0.0 || u + v > 1.0)
-        return false;
-
-    // line intersection but not ray intersection
-    double t = f * dot(B, q);
-    if (t <= epsilon)
-        return false;
-
-    rec.t = t;
-    rec.p = r.at(rec.t);
-    rec.set_face_normal(r, rec.p);
-    rec.mat_ptr = mat_ptr;
-
-    return true;
-}
-
 #endif  // TRIANGLE_H
\ No newline at end of file
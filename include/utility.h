@@ -29,6 +29,7 @@
 #define UTILITY_H
 
 #include <cmath>
+#include <cstdint>
 #include <limits>
 #include <random>
 
@@ -43,18 +44,37 @@ inline double degrees_to_radians(double degrees)
     return (degrees * pi) / 180.0;
 }
 
+// Every thread owns a generator, so concurrent renders never share state and
+// are reproducible once each unit of work seeds it.
+inline std::mt19937 &random_generator()
+{
+    thread_local std::mt19937 gen;
+    return gen;
+}
+
+// Combines a seed with a value (e.g. a tile position) using SplitMix64.
+inline uint64_t hash_seed(uint64_t seed, uint64_t value)
+{
+    uint64_t z = seed + 0x9e3779b97f4a7c15ULL * (value + 1);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+inline void seed_random(uint64_t seed)
+{
+    random_generator().seed(static_cast<uint32_t>(seed ^ (seed >> 32)));
+}
+
 inline double random_double()
 {
-    static std::uniform_real_distribution<double> dist(0.0, 1.0);
-    static std::mt19937 gen;
-    return dist(gen);
+    std::uniform_real_distribution<double> dist(0.0, 1.0);
+    return dist(random_generator());
 }
 
 inline double random_double(double min, double max)
 {
-    static std::uniform_real_distribution<double> dist(min, max);
-    static std::mt19937 gen;
-    return dist(gen);
+    return min + (max - min) * random_double();
 }
 
 inline double clamp(double x, double min, double max)
@@ -135,7 +135,7 @@ inline vec3 cross(const vec3 &u, const vec3 &v)
 
 inline vec3 unit_vector(vec3 v) { return v / v.length(); }
 
-vec3 random_in_unit_sphere()
+inline vec3 random_in_unit_sphere()
 {
     while (true)
     {
@@ -147,12 +147,15 @@ vec3 random_in_unit_sphere()
     }
 }
 
-vec3 random_unit_vector() { return unit_vector(vec3::random()); }
+inline vec3 random_unit_vector() { return unit_vector(vec3::random()); }
 
-vec3 reflect(const vec3 &v, const vec3 &n) { return v - 2 * dot(v, n) * n; }
+inline vec3 reflect(const vec3 &v, const vec3 &n)
+{
+    return v - 2 * dot(v, n) * n;
+}
 
 // Solving for the refraction using Snell's Law
-vec3 refract(const vec3 &uv, const vec3 &n, double etai_over_eta)
+inline vec3 refract(const vec3 &uv, const vec3 &n, double etai_over_eta)
 {
     auto cos_theta = fmin(dot(-uv, n), 1.0);
     vec3 r_perp = etai_over_eta * (uv + cos_theta * n);
@@ -161,7 +164,7 @@ vec3 refract(const vec3 &uv, const vec3 &n, double etai_over_eta)
     return r_perp + r_pl;
 }
 
-vec3 random_in_unit_disk()
+inline vec3 random_in_unit_disk()
 {
     while (true)
     {
@@ -0,0 +1,390 @@
+/*
+ * This file is part of Simple Ray Tracer.
+ * (https://github.com/ericwoude/ray-tracer)
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright © 2022 Eric van der Woude
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the “Software”), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef WIDE_BVH_H
+#define WIDE_BVH_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+#include "aabb.h"
+#include "bvh.h"
+#include "hittable.h"
+#include "hittable_list.h"
+#include "memory_ledger.h"
+
+/*
+ *  Four-wide bounding volume hierarchy with compressed nodes. A node stores
+ *  its own box as a float origin plus a power-of-two scale per axis, and the
+ *  boxes of its children as 8-bit offsets in that grid, rounded outwards so
+ *  they always contain the exact box. A node fits in one cache line and
+ *  replaces three binary nodes.
+ *
+ *  It is collapsed from a binary bvh, which is freed after construction.
+ */
+class wide_bvh : public hittable
+{
+   public:
+    wide_bvh() {}
+    explicit wide_bvh(const hittable_list& list)
+    {
+        bvh binary(list);
+        primitives = binary.primitives;
+
+        if (!binary.nodes.empty())
+            collapse(binary, 0);
+
+        charge = memory_charge(
+            memory_category::acceleration,
+            nodes.capacity() * sizeof(node) +
+                primitives.capacity() * sizeof(primitives[0]));
+    }
+
+    virtual bool hit(const ray& r, double t_min, double t_max,
+                     hit_record& rec) const override
+    {
+        if (nodes.empty())
+            return false;
+
+        struct entry
+        {
+            uint32_t child;
+            double t;
+        };
+
+        entry stack[96];
+        int top = 0;
+        bool hit = false;
+        double closest = t_max;
+
+        vec3 inv(1.0 / r.direction().x(), 1.0 / r.direction().y(),
+                 1.0 / r.direction().z());
+        stack[top++] = {0, t_min};
+
+        while (top > 0)
+        {
+            entry e = stack[--top];
+            if (e.t > closest)
+                continue;
+
+            if (e.child & leaf_flag)
+            {
+                int start = e.child & start_mask;
+                int end = start + ((e.child >> count_shift) & count_mask);
+
+                for (int i = start; i < end; i++)
+                {
+                    if (primitives[i]->hit(r, t_min, closest, rec))
+                    {
+                        hit = true;
+                        closest = rec.t;
+                    }
+                }
+                continue;
+            }
+
+            double t_near[4];
+            bool overlap[4];
+            intersect_children(nodes[e.child], r, inv, t_min, closest,
+                               t_near, overlap);
+
+            // Push the children far to near, so the nearest is popped first.
+            int order[4], n = 0;
+            for (int i = 0; i < 4; i++)
+            {
+                if (!overlap[i])
+                    continue;
+
+                int j = n++;
+                while (j > 0 && t_near[order[j - 1]] < t_near[i])
+                {
+                    order[j] = order[j - 1];
+                    j--;
+                }
+                order[j] = i;
+            }
+
+            const node& parent = nodes[e.child];
+            for (int k = 0; k < n; k++)
+                stack[top++] = {parent.child[order[k]], t_near[order[k]]};
+        }
+
+        return hit;
+    }
+
+    virtual bool bounding_box(aabb& output_box) const override
+    {
+        if (nodes.empty())
+            return false;
+
+        output_box = root_box;
+        return true;
+    }
+
+    // Recomputes and requantizes all boxes after objects moved.
+    void refit()
+    {
+        std::vector<aabb> exact(nodes.size());
+
+        for (int i = static_cast<int>(nodes.size()) - 1; i >= 0; i--)
+        {
+            aabb child_boxes[4];
+            aabb box;
+
+            for (int c = 0; c < 4; c++)
+            {
+                uint32_t ref = nodes[i].child[c];
+                if (ref == empty_child)
+                    continue;
+
+                child_boxes[c] = ref & leaf_flag ? leaf_box(ref) : exact[ref];
+                box.expand(child_boxes[c]);
+            }
+
+            exact[i] = box;
+            quantize(nodes[i], box, child_boxes);
+        }
+
+        if (!nodes.empty())
+            root_box = exact[0];
+    }
+
+    size_t node_count() const { return nodes.size(); }
+    size_t node_bytes() const { return nodes.size() * sizeof(node); }
+
+    virtual void footprint(scene_footprint& f) const override
+    {
+        for (const auto& p : primitives)
+            p->footprint(f);
+    }
+
+   private:
+    static const uint32_t empty_child = 0xffffffff;
+    static const uint32_t leaf_flag = 0x80000000;
+    static const uint32_t count_shift = 24;
+    static const uint32_t count_mask = 0x7f;
+    static const uint32_t start_mask = 0xffffff;
+
+    struct alignas(64) node
+    {
+        float origin[3];
+        int8_t exponent[3];
+        uint8_t lo[3][4];
+        uint8_t hi[3][4];
+
+        // Index of an interior child, or a leaf_flag reference holding the
+        // first primitive and the amount of primitives.
+        uint32_t child[4];
+    };
+
+    // Slab tests against all four children; written lane by lane so the
+    // compiler can vectorize it.
+    static void intersect_children(const node& n, const ray& r,
+                                   const vec3& inv, double t_min,
+                                   double t_max, double t_near[4],
+                                   bool overlap[4])
+    {
+        double t0[4], t1[4];
+        for (int i = 0; i < 4; i++)
+        {
+            t0[i] = t_min;
+            t1[i] = t_max;
+        }
+
+        for (int a = 0; a < 3; a++)
+        {
+            double scale = power_of_two(n.exponent[a]);
+            double o = (n.origin[a] - r.origin()[a]) * inv[a];
+            double s = scale * inv[a];
+
+            for (int i = 0; i < 4; i++)
+            {
+                double lo = o + n.lo[a][i] * s;
+                double hi = o + n.hi[a][i] * s;
+                double near = lo < hi ? lo : hi;
+                double far = lo < hi ? hi : lo;
+
+                t0[i] = near > t0[i] ? near : t0[i];
+                t1[i] = far < t1[i] ? far : t1[i];
+            }
+        }
+
+        for (int i = 0; i < 4; i++)
+        {
+            t_near[i] = t0[i];
+            overlap[i] = n.child[i] != empty_child && t0[i] <= t1[i];
+        }
+    }
+
+    // 2^e built directly from the exponent bits, cheaper than ldexp.
+    static double power_of_two(int e)
+    {
+        uint64_t bits = static_cast<uint64_t>(e + 1023) << 52;
+        double d;
+        std::memcpy(&d, &bits, sizeof(d));
+        return d;
+    }
+
+    aabb leaf_box(uint32_t ref) const
+    {
+        int start = ref & start_mask;
+        int end = start + ((ref >> count_shift) & count_mask);
+        aabb box, tmp;
+
+        for (int i = start; i < end; i++)
+        {
+            primitives[i]->bounding_box(tmp);
+            box.expand(tmp);
+        }
+
+        return box;
+    }
+
+    /*
+     *  Stores box as origin and per-axis scale, and each child box as the
+     *  grid cells that cover it. The scale is the smallest power of two for
+     *  which 255 cells span the box.
+     */
+    static void quantize(node& n, const aabb& box, const aabb child_boxes[4])
+    {
+        for (int a = 0; a < 3; a++)
+        {
+            float o = static_cast<float>(box.min()[a]);
+            if (o > box.min()[a])
+                o = std::nextafter(o, -std::numeric_limits<float>::infinity());
+
+            double extent = box.max()[a] - o;
+            int e = -127;
+            if (extent > 0)
+                e = static_cast<int>(std::ceil(std::log2(extent / 255)));
+            if (std::ldexp(255.0, e) < extent)
+                e++;  // log2 rounded down
+            e = std::max(-127, std::min(127, e));
+            double scale = std::ldexp(1.0, e);
+
+            n.origin[a] = o;
+            n.exponent[a] = e;
+
+            for (int i = 0; i < 4; i++)
+            {
+                if (n.child[i] == empty_child)
+                {
+                    n.lo[a][i] = 255;
+                    n.hi[a][i] = 0;
+                    continue;
+                }
+
+                double lo = std::floor((child_boxes[i].min()[a] - o) / scale);
+                double hi = std::ceil((child_boxes[i].max()[a] - o) / scale);
+                n.lo[a][i] = static_cast<uint8_t>(std::max(0.0, lo));
+                n.hi[a][i] = static_cast<uint8_t>(std::min(255.0, hi));
+            }
+        }
+    }
+
+    /*
+     *  Turns binary node b and its descendants into a wide node: children
+     *  are opened, largest surface area first, until there are four of them
+     *  or only leaves remain.
+     */
+    uint32_t collapse(const bvh& b, int index)
+    {
+        std::vector<int> open = {index};
+        if (b.nodes[index].count == 0)
+            open = {index + 1, b.nodes[index].right};
+
+        while (open.size() < 4)
+        {
+            int best = -1;
+            double best_area = -1;
+
+            for (size_t i = 0; i < open.size(); i++)
+            {
+                const bvh::node& c = b.nodes[open[i]];
+                vec3 d = c.box.max() - c.box.min();
+                double area = d.x() * d.y() + d.y() * d.z() + d.z() * d.x();
+
+                if (c.count == 0 && area > best_area)
+                {
+                    best = i;
+                    best_area = area;
+                }
+            }
+
+            if (best < 0)
+                break;
+
+            int opened = open[best];
+            open[best] = opened + 1;
+            open.push_back(b.nodes[opened].right);
+        }
+
+        uint32_t self = nodes.size();
+        nodes.emplace_back();
+        if (self == 0)
+            root_box = b.nodes[index].box;
+
+        aabb child_boxes[4];
+        uint32_t child[4] = {empty_child, empty_child, empty_child,
+                             empty_child};
+
+        for (size_t i = 0; i < open.size(); i++)
+        {
+            const bvh::node& c = b.nodes[open[i]];
+            child_boxes[i] = c.box;
+
+            if (c.count > 0)
+            {
+                if (static_cast<uint32_t>(c.start) > start_mask)
+                    throw std::runtime_error("wide_bvh: too many objects");
+
+                child[i] = leaf_flag | (c.count << count_shift) | c.start;
+            }
+            else
+                child[i] = collapse(b, open[i]);
+        }
+
+        for (int i = 0; i < 4; i++)
+            nodes[self].child[i] = child[i];
+        quantize(nodes[self], b.nodes[index].box, child_boxes);
+
+        return self;
+    }
+
+    std::vector<node> nodes;
+    std::vector<std::shared_ptr<hittable>> primitives;
+    aabb root_box;
+    memory_charge charge;
+};
+
+#endif  // WIDE_BVH_H
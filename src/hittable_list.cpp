@@ -0,0 +1,105 @@
+/*
+ * This file is part of Simple Ray Tracer.
+ * (https://github.com/ericwoude/ray-tracer)
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright © 2022 Eric van der Woude
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the “Software”), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "hittable_list.h"
+
+#include <algorithm>
+
+#include "memory_ledger.h"
+
+bool hittable_list::hit(const ray& r, double t_min, double t_max,
+                        hit_record& rec) const
+{
+    hit_record tmp;
+    bool hit = false;
+    double closest = t_max;
+
+    for (const auto& o : objects)
+    {
+        if (o->hit(r, t_min, closest, tmp))
+        {
+            hit = true;
+            closest = tmp.t;
+            rec = tmp;
+        }
+    }
+
+    return hit;
+}
+
+bool hittable_list::bounding_box(aabb& output_box) const
+{
+    if (objects.empty())
+        return false;
+
+    aabb tmp;
+    output_box = aabb();
+
+    for (const auto& o : objects)
+    {
+        if (!o->bounding_box(tmp))
+            return false;
+
+        output_box.expand(tmp);
+    }
+
+    return true;
+}
+
+// Batches go to every object whole, so objects can batch in turn.
+void hittable_list::hit_batch(const std::vector<ray>& rays, double t_min,
+                              double t_max, std::vector<hit_record>& recs,
+                              std::vector<char>& hits) const
+{
+    std::vector<hit_record> tmp(rays.size());
+    std::vector<char> tmp_hits(rays.size());
+    std::fill(hits.begin(), hits.end(), false);
+
+    for (const auto& o : objects)
+    {
+        o->hit_batch(rays, t_min, t_max, tmp, tmp_hits);
+
+        for (size_t i = 0; i < rays.size(); i++)
+        {
+            if (tmp_hits[i] && (!hits[i] || tmp[i].t < recs[i].t))
+            {
+                hits[i] = true;
+                recs[i] = tmp[i];
+            }
+        }
+    }
+}
+
+void hittable_list::footprint(scene_footprint& f) const
+{
+    if (!f.add(this, memory_category::primitives,
+               sizeof(*this) + objects.capacity() * sizeof(objects[0])))
+        return;
+
+    for (const auto& o : objects)
+        o->footprint(f);
+}
@@ -0,0 +1,178 @@
+/*
+ * This file is part of Simple Ray Tracer.
+ * (https://github.com/ericwoude/ray-tracer)
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright © 2022 Eric van der Woude
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the “Software”), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "image.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+
+#include "color.h"
+
+// Skips whitespace and comments between header fields.
+static void skip_separators(std::istream &in)
+{
+    while (true)
+    {
+        in >> std::ws;
+        if (in.peek() != '#')
+            return;
+
+        std::string comment;
+        std::getline(in, comment);
+    }
+}
+
+image read_ppm(std::istream &in)
+{
+    std::string magic;
+    int max_value = 0;
+    image img;
+
+    in >> magic;
+    skip_separators(in);
+    in >> img.width;
+    skip_separators(in);
+    in >> img.height;
+    skip_separators(in);
+    in >> max_value;
+
+    if (!in || (magic != "P3" && magic != "P6") || max_value != 255 ||
+        img.width <= 0 || img.height <= 0)
+        throw std::runtime_error("unsupported PPM");
+
+    img.rgb.resize(img.width * img.height * 3);
+
+    if (magic == "P6")
+    {
+        in.get();  // single whitespace before the data
+        in.read(reinterpret_cast<char *>(img.rgb.data()), img.rgb.size());
+    }
+    else
+    {
+        for (auto &c : img.rgb)
+        {
+            int v;
+            in >> v;
+            c = static_cast<unsigned char>(v);
+        }
+    }
+
+    if (!in)
+        throw std::runtime_error("truncated PPM");
+
+    return img;
+}
+
+void write_ppm(std::ostream &out, const image &img)
+{
+    out << "P3\n" << img.width << " " << img.height << "\n255\n";
+
+    for (size_t i = 0; i < img.rgb.size(); i += 3)
+    {
+        out << static_cast<int>(img.rgb[i]) << " "
+            << static_cast<int>(img.rgb[i + 1]) << " "
+            << static_cast<int>(img.rgb[i + 2]) << "\n";
+    }
+}
+
+image to_image(const framebuffer &fb)
+{
+    image img;
+    img.width = fb.width();
+    img.height = fb.height();
+    img.rgb.reserve(img.width * img.height * 3);
+
+    fb.for_each_pixel([&](int x, int y) {
+        color c = fb.sum(x, y);
+        int n = std::max(fb.samples(x, y), 1);
+
+        img.rgb.push_back(to_byte(c.x(), n));
+        img.rgb.push_back(to_byte(c.y(), n));
+        img.rgb.push_back(to_byte(c.z(), n));
+    });
+
+    return img;
+}
+
+void paste(image &dst, const image &src, int x, int y)
+{
+    for (int j = std::max(0, -y); j < src.height && y + j < dst.height; j++)
+    {
+        for (int i = std::max(0, -x); i < src.width && x + i < dst.width; i++)
+        {
+            for (int c = 0; c < 3; c++)
+            {
+                dst.rgb[((y + j) * dst.width + x + i) * 3 + c] =
+                    src.rgb[(j * src.width + i) * 3 + c];
+            }
+        }
+    }
+}
+
+// Channel c of the average over the square around (x, y), clipped to img.
+static double box_average(const image &img, int x, int y, int c, int radius)
+{
+    double sum = 0;
+    int count = 0;
+
+    for (int j = std::max(0, y - radius);
+         j <= std::min(img.height - 1, y + radius); j++)
+    {
+        for (int i = std::max(0, x - radius);
+             i <= std::min(img.width - 1, x + radius); i++)
+        {
+            sum += img.rgb[(j * img.width + i) * 3 + c];
+            count++;
+        }
+    }
+
+    return sum / count;
+}
+
+double rms_difference(const image &a, const image &b, int radius)
+{
+    if (a.width != b.width || a.height != b.height)
+        throw std::runtime_error("images differ in size");
+
+    double sum = 0;
+    for (int y = 0; y < a.height; y++)
+    {
+        for (int x = 0; x < a.width; x++)
+        {
+            for (int c = 0; c < 3; c++)
+            {
+                double d = box_average(a, x, y, c, radius) -
+                           box_average(b, x, y, c, radius);
+                sum += d * d;
+            }
+        }
+    }
+
+    return sqrt(sum / std::max<size_t>(a.rgb.size(), 1));
+}
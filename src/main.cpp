@@ -25,184 +25,594 @@
  * SOFTWARE.
  */
 
+#include <algorithm>
+#include <chrono>
 #include <cmath>
+#include <csignal>
 #include <cstdlib>
-#include <functional>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
 #include <thread>
 
+#include "animation.h"
 #include "camera.h"
+#include "checkpoint.h"
 #include "color.h"
+#include "distributed.h"
 #include "hittable_list.h"
+#include "image.h"
 #include "material.h"
+#include "memory_ledger.h"
+#include "paged_mesh.h"
+#include "radiance_cache.h"
 #include "ray.h"
+#include "ray_counter.h"
+#include "render.h"
+#include "scenes.h"
+#include "service.h"
 #include "sphere.h"
+#include "texture.h"
+#include "thread_pool.h"
 #include "triangle.h"
 #include "utility.h"
 #include "vec3.h"
+#include "wide_bvh.h"
 
 using std::make_shared;
 
-color ray_color(const ray& r, const hittable& world, int depth)
+const char* usage =
+    "usage: raytracer [options]\n"
+    "  --size <w> <h>          image resolution\n"
+    "  --samples <n>           samples per pixel\n"
+    "  --threads <n>           amount of worker threads\n"
+    "  --seed <n>              seed for the world and the samples\n"
+    "  --serve                 read render jobs from stdin\n"
+    "  --coordinator <port>    hand out tiles to workers connecting on port\n"
+    "  --worker <host:port>    render tiles for a coordinator\n"
+    "  --checkpoint <file>     render in passes and save progress to file\n"
+    "  --checkpoint-interval <s>  seconds between checkpoints (default 60)\n"
+    "  --pass-samples <n>      samples per pixel per pass (default 16)\n"
+    "  --resume                continue from the checkpoint if it exists\n"
+    "  --time-budget <s>       stop refining after s seconds, --samples is\n"
+    "                          then the upper bound\n"
+    "  --animate <frames>      render a sequence of frames to files\n"
+    "  --fps <n>               frames per second (default 24)\n"
+    "  --orbit <degrees>       camera turn per second (default 15)\n"
+    "  --output <prefix>       file prefix of the frames (default frame_)\n"
+    "  --write-mesh <file> <n> write a chunked field of n x n pyramids\n"
+    "  --mesh <file>           render a chunked mesh, paging it from disk\n"
+    "  --cache-mb <n>          memory budget of mesh chunks (default 256)\n"
+    "  --crop <x0> <y0> <x1> <y1>  only render this pixel rectangle\n"
+    "  --composite <ppm>       paste the crop into this full frame\n"
+    "  --preview <levels>      first write previews at 1/2 ... 1/2^(levels-1)\n"
+    "                          resolution, named <output>preview_<level>.ppm\n"
+    "  --views <file>          render every view listed in file to\n"
+    "                          <output>view_<n>.ppm\n"
+    "  --make-texture <ppm> <file>  convert an image to a tiled mip-mapped\n"
+    "                          texture file\n"
+    "  --texture <file>        wrap a texture file around the diffuse sphere\n"
+    "  --texture-cache-mb <n>  memory budget of texture tiles (default 64)\n"
+    "  --memory                report memory use by category after rendering\n"
+    "  --radiance-cache <size> end diffuse paths in a cache of light with\n"
+    "                          cells of this size after the first bounce\n"
+    "  --count-rays            report the rays traced per sample\n";
+
+/*
+ *  Renders a quick version of the frame at every level below the full one,
+ *  coarsest first; level k has 1/2^k of the resolution along each axis and
+ *  1/4^k of the samples, so it costs 1/16^k of the full frame and all
+ *  previews together cost at most 1/15 of it.
+ */
+void render_previews(const hittable& world, const render_settings& s,
+                     const camera_params& view, int levels,
+                     const std::string& prefix, thread_pool& pool)
+{
+    for (int k = levels - 1; k > 0; k--)
+    {
+        render_settings level = s;
+        level.width = std::max(2, s.width >> k);
+        level.height = std::max(2, s.height >> k);
+        level.sample_amount = std::max(1, s.sample_amount >> (2 * k));
+
+        auto start = std::chrono::steady_clock::now();
+        framebuffer fb = render(make_camera(view, level), world, level, pool);
+        std::ofstream out(prefix + "preview_" + std::to_string(k) + ".ppm");
+        write_ppm(out, fb);
+
+        std::chrono::duration<double> elapsed =
+            std::chrono::steady_clock::now() - start;
+        std::cerr << "preview " << k << " (" << level.width << "x"
+                  << level.height << ", " << level.sample_amount
+                  << " samples) took " << elapsed.count() << "s\n";
+    }
+}
+
+// Registers the bytes of everything world refers to with the memory ledger,
+// for as long as the result lives.
+std::vector<memory_charge> charge_scene(const hittable& world)
 {
-    hit_record rec;
+    scene_footprint f;
+    world.footprint(f);
 
-    if (depth <= 0)
-        return color(0, 0, 0);
+    std::vector<memory_charge> charges;
+    for (int c = 0; c < memory_category_count; c++)
+        charges.emplace_back(static_cast<memory_category>(c), f.bytes[c]);
 
-    if (world.hit(r, 0.001, infinity, rec))
-    {
-        ray scattered;
-        color attenuation;
+    return charges;
+}
+
+/*
+ *  Reads one view per line: lookfrom (3 numbers), lookat (3), vfov,
+ *  aperture, focus distance, width, height and optionally the samples per
+ *  pixel, which must be a positive integer. A '#' starts a comment that
+ *  runs to the end of the line; empty and comment lines are skipped.
+ */
+std::vector<view_job> read_views(std::istream& in,
+                                 const render_settings& defaults)
+{
+    std::vector<view_job> views;
+    std::string line;
+    int number = 0;
 
-        if (rec.mat_ptr->scatter(r, rec, attenuation, scattered))
-            return attenuation * ray_color(scattered, world, depth - 1);
+    while (std::getline(in, line))
+    {
+        number++;
+        std::istringstream words(line);
+        std::string first;
+        if (!(words >> first) || first[0] == '#')
+            continue;
+
+        words.clear();
+        words.seekg(0);
+
+        view_job v;
+        camera_params& p = v.view;
+        v.settings = defaults;
+        const std::runtime_error invalid("invalid view on line " +
+                                         std::to_string(number));
+
+        if (!(words >> p.lookfrom[0] >> p.lookfrom[1] >> p.lookfrom[2] >>
+              p.lookat[0] >> p.lookat[1] >> p.lookat[2] >> p.vfov >>
+              p.aperture >> p.focus_dist >> v.settings.width >>
+              v.settings.height) ||
+            v.settings.width < 2 || v.settings.height < 2)
+            throw invalid;
+
+        std::string word;
+        if (words >> word && word[0] != '#')
+        {
+            std::istringstream samples(word);
+            char extra;
+            if (!(samples >> v.settings.sample_amount) || samples >> extra ||
+                v.settings.sample_amount < 1)
+                throw invalid;
+
+            if (words >> word && word[0] != '#')
+                throw invalid;
+        }
 
-        return color(0, 0, 0);
+        views.push_back(v);
     }
 
-    vec3 u_dir = unit_vector(r.direction());
-    double t = 0.5 * (u_dir.y() + 1.0);
-    return (1.0 - t) * color(1.0, 1.0, 1.0) + t * color(0.5, 0.7, 1.0);
+    return views;
 }
 
-hittable_list generate_world()
+// The signal that asked the render to stop, or zero.
+volatile std::sig_atomic_t stop_requested = 0;
+
+void request_stop(int signal) { stop_requested = signal; }
+
+/*
+ *  Renders in passes, saving the accumulation buffer every interval and
+ *  when the process is asked to terminate, e.g. on instance preemption.
+ */
+framebuffer render_checkpointed(const camera& cam, const hittable& world,
+                                const render_settings& s,
+                                const camera_params& view, int pass_samples,
+                                const std::string& path, double interval,
+                                bool resume, thread_pool& pool)
 {
-    hittable_list world;
+    framebuffer fb(s.width, s.height);
+    if (resume && load_checkpoint(path, s, view, pass_samples, fb))
+        std::cerr << "resuming " << path << " at " << fb.min_samples()
+                  << " samples\n";
 
-    auto ground_material = make_shared<lambertian>(color(0.5, 0.5, 0.5));
-    world.add(make_shared<sphere>(point3(0, -1000, 0), 1000, ground_material));
+    std::signal(SIGTERM, request_stop);
+    std::signal(SIGINT, request_stop);
 
-    for (int a = -11; a < 11; a++)
-    {
-        for (int b = -11; b < 11; b++)
+    auto last_save = std::chrono::steady_clock::now();
+    render_progressive(cam, world, s, pass_samples, pool, fb, [&] {
+        auto now = std::chrono::steady_clock::now();
+        std::chrono::duration<double> elapsed = now - last_save;
+
+        if (stop_requested || elapsed.count() >= interval)
         {
-            auto choose_mat = random_double();
-            point3 center(a + 0.9 * random_double(), 0.2,
-                          b + 0.9 * random_double());
+            save_checkpoint(path, fb, s, view, pass_samples);
+            last_save = now;
+        }
+
+        return !stop_requested;
+    });
+
+    save_checkpoint(path, fb, s, view, pass_samples);
+    if (stop_requested)
+        std::cerr << "stopped at " << fb.min_samples() << " samples\n";
+
+    return fb;
+}
 
-            if ((center - point3(4, 0.2, 0)).length() > 0.9)
+int main(int argc, char* argv[])
+{
+    render_settings settings;
+    camera_params view;
+    unsigned int thread_amount = std::thread::hardware_concurrency();
+    bool serve = false;
+    int coordinator_port = 0;
+    std::string worker_address;
+    std::string checkpoint_path;
+    double checkpoint_interval = 60;
+    int pass_samples = 16;
+    bool resume = false;
+    double time_budget = 0;
+    animation_settings animation;
+    bool animate = false;
+    std::string mesh_path;
+    int mesh_grid = 0;
+    size_t cache_mb = 256;
+    tile crop = {0, 0, 0, 0};
+    bool crop_given = false;
+    std::string composite_path;
+    int preview_levels = 0;
+    std::string views_path;
+    std::string texture_source;
+    std::string texture_path;
+    size_t texture_cache_mb = 64;
+    bool memory_report = false;
+    double cache_cell = 0;
+    bool count_rays = false;
+
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+
+        if (arg == "--serve")
+            serve = true;
+        else if (arg == "--size" && i + 2 < argc)
+        {
+            settings.width = std::atoi(argv[++i]);
+            settings.height = std::atoi(argv[++i]);
+            if (settings.width < 2 || settings.height < 2)
+            {
+                std::cerr << usage;
+                return 1;
+            }
+        }
+        else if (arg == "--samples" && i + 1 < argc)
+        {
+            settings.sample_amount = std::atoi(argv[++i]);
+            if (settings.sample_amount < 1)
             {
-                std::shared_ptr<material> sphere_material;
-
-                if (choose_mat < 0.8)
-                {
-                    // diffuse
-                    auto albedo = color::random() * color::random();
-                    sphere_material = make_shared<lambertian>(albedo);
-                    world.add(
-                        make_shared<sphere>(center, 0.2, sphere_material));
-                }
-                else if (choose_mat < 0.95)
-                {
-                    // metal
-                    auto albedo = color::random(0.5, 1);
-                    auto fuzz = random_double(0, 0.5);
-                    sphere_material = make_shared<metal>(albedo, fuzz);
-                    world.add(
-                        make_shared<sphere>(center, 0.2, sphere_material));
-                }
-                else
-                {
-                    // glass
-                    sphere_material = make_shared<dielectric>(1.5);
-                    world.add(
-                        make_shared<sphere>(center, 0.2, sphere_material));
-                }
+                std::cerr << usage;
+                return 1;
             }
         }
+        else if (arg == "--threads" && i + 1 < argc)
+        {
+            int n = std::atoi(argv[++i]);
+            if (n < 1)
+            {
+                std::cerr << usage;
+                return 1;
+            }
+            thread_amount = n;
+        }
+        else if (arg == "--seed" && i + 1 < argc)
+            settings.seed = std::strtoull(argv[++i], nullptr, 10);
+        else if (arg == "--coordinator" && i + 1 < argc)
+            coordinator_port = std::atoi(argv[++i]);
+        else if (arg == "--worker" && i + 1 < argc)
+            worker_address = argv[++i];
+        else if (arg == "--checkpoint" && i + 1 < argc)
+            checkpoint_path = argv[++i];
+        else if (arg == "--checkpoint-interval" && i + 1 < argc)
+            checkpoint_interval = std::atof(argv[++i]);
+        else if (arg == "--pass-samples" && i + 1 < argc)
+            pass_samples = std::max(1, std::atoi(argv[++i]));
+        else if (arg == "--resume")
+            resume = true;
+        else if (arg == "--time-budget" && i + 1 < argc)
+            time_budget = std::atof(argv[++i]);
+        else if (arg == "--animate" && i + 1 < argc)
+        {
+            animate = true;
+            animation.frames = std::atoi(argv[++i]);
+        }
+        else if (arg == "--fps" && i + 1 < argc)
+            animation.fps = std::atof(argv[++i]);
+        else if (arg == "--orbit" && i + 1 < argc)
+            animation.orbit = std::atof(argv[++i]);
+        else if (arg == "--output" && i + 1 < argc)
+            animation.output = argv[++i];
+        else if (arg == "--write-mesh" && i + 2 < argc)
+        {
+            mesh_path = argv[++i];
+            mesh_grid = std::atoi(argv[++i]);
+        }
+        else if (arg == "--mesh" && i + 1 < argc)
+            mesh_path = argv[++i];
+        else if (arg == "--cache-mb" && i + 1 < argc)
+            cache_mb = std::atoi(argv[++i]);
+        else if (arg == "--crop" && i + 4 < argc)
+        {
+            crop.x0 = std::atoi(argv[++i]);
+            crop.y0 = std::atoi(argv[++i]);
+            crop.x1 = std::atoi(argv[++i]);
+            crop.y1 = std::atoi(argv[++i]);
+            crop_given = true;
+        }
+        else if (arg == "--composite" && i + 1 < argc)
+            composite_path = argv[++i];
+        else if (arg == "--preview" && i + 1 < argc)
+            preview_levels = std::atoi(argv[++i]);
+        else if (arg == "--views" && i + 1 < argc)
+            views_path = argv[++i];
+        else if (arg == "--make-texture" && i + 2 < argc)
+        {
+            texture_source = argv[++i];
+            texture_path = argv[++i];
+        }
+        else if (arg == "--texture" && i + 1 < argc)
+            texture_path = argv[++i];
+        else if (arg == "--texture-cache-mb" && i + 1 < argc)
+            texture_cache_mb = std::atoi(argv[++i]);
+        else if (arg == "--memory")
+            memory_report = true;
+        else if (arg == "--radiance-cache" && i + 1 < argc)
+            cache_cell = std::atof(argv[++i]);
+        else if (arg == "--count-rays")
+            count_rays = true;
+        else
+        {
+            std::cerr << usage;
+            return 1;
+        }
     }
 
-    auto material1 = make_shared<dielectric>(1.5);
-    world.add(make_shared<sphere>(point3(0, 1, 0), 1.0, material1));
+    thread_pool pool(thread_amount);
 
-    auto material2 = make_shared<lambertian>(color(0.4, 0.2, 0.1));
-    world.add(make_shared<sphere>(point3(-4, 1, 0), 1.0, material2));
+    try
+    {
+        if (!worker_address.empty())
+        {
+            auto colon = worker_address.rfind(':');
+            if (colon == std::string::npos)
+            {
+                std::cerr << usage;
+                return 1;
+            }
 
-    auto material3 = make_shared<metal>(color(0.7, 0.6, 0.5), 0.0);
-    world.add(make_shared<sphere>(point3(4, 1, 0), 1.0, material3));
+            run_worker(worker_address.substr(0, colon),
+                       std::atoi(worker_address.c_str() + colon + 1),
+                       [](uint64_t seed) {
+                           seed_random(seed);
+                           return make_shared<wide_bvh>(generate_world());
+                       },
+                       pool);
+            return 0;
+        }
 
-    return world;
-}
+        if (coordinator_port > 0)
+        {
+            coordinator c(coordinator_port, view, settings);
+            write_ppm(std::cout, c.run());
+            return 0;
+        }
 
-int main()
-{
-    // Screen
-    const auto aspect_ratio = 16.0 / 9.0;
-    const int width = 400;
-    const int height = static_cast<int>(width / aspect_ratio);
-    const int sample_amount = 500;
-    const int depth = 30;
-
-    // Camera
-    point3 lookfrom(13, 2, 3);
-    point3 lookat(0, 0, 0);
-    vec3 vup(0, 1, 0);
-    auto dist_to_focus = 10.0;
-    auto aperture = 0.1;
-
-    camera cam(lookfrom, lookat, vup, 20, aspect_ratio, aperture,
-               dist_to_focus);
-
-    // Render
-    std::cout << "P3\n" << width << " " << height << "\n255\n";
-    auto world = generate_world();
-
-    auto partial_render = [cam, world](int s, int e,
-                                       std::vector<color>& screen) {
-        div_t dv;
-        int row = 0;
-        int col = 0;
-
-        for (int x = s; x < e; x++)
-        {
-            dv = std::div(x, width);
-            row = (height - 1) - dv.quot;
-            col = dv.rem;
-
-            color pixel_color(0, 0, 0);
-
-            for (int k = 0; k < sample_amount; k++)
+        if (mesh_grid > 0)
+        {
+            seed_random(settings.seed);
+            write_pyramid_field(mesh_path, mesh_grid);
+            return 0;
+        }
+
+        if (!texture_source.empty())
+        {
+            std::ifstream in(texture_source, std::ios::binary);
+            if (!in)
+                throw std::runtime_error("cannot open " + texture_source);
+
+            write_texture(texture_path, read_ppm(in));
+            return 0;
+        }
+
+        if (!mesh_path.empty())
+        {
+            // Only the recursive loop uses the cache, and meshes are always
+            // traced a bounce at a time.
+            if (cache_cell > 0)
+                throw std::runtime_error(
+                    "--radiance-cache cannot be combined with --mesh");
+
+            auto mesh = make_shared<paged_mesh>(mesh_path, cache_mb << 20,
+                                                mesh_palette());
+            hittable_list world(mesh);
+            world.add(make_shared<sphere>(
+                point3(0, -1000, 0), 1000,
+                make_shared<lambertian>(color(0.5, 0.5, 0.5))));
+
+            settings.wavefront = true;
+            auto scene_memory = charge_scene(world);
+            camera cam = make_camera(view, settings);
+            framebuffer fb = render(cam, world, settings, pool);
+            write_ppm(std::cout, fb);
+
+            std::cerr << mesh->chunk_count() << " chunks, "
+                      << mesh->cache.loads() << " loads, "
+                      << mesh->cache.hits() << " cache hits, peak "
+                      << (mesh->cache.peak_bytes() >> 20)
+                      << " MiB resident\n";
+            if (memory_report)
+                write_memory_report(std::cerr, memory_usage());
+            return 0;
+        }
+
+        if (animate)
+        {
+            render_animation(
+                [&] { return generate_animated_world(settings.seed); }, view,
+                settings, animation, pool);
+            return 0;
+        }
+
+        std::shared_ptr<texture_cache> textures;
+        std::shared_ptr<texture> globe;
+        if (!texture_path.empty())
+        {
+            textures = make_shared<texture_cache>(texture_cache_mb << 20);
+            globe = make_shared<image_texture>(textures, texture_path);
+        }
+
+        seed_random(settings.seed);
+        wide_bvh world(generate_world(globe));
+        auto scene_memory = charge_scene(world);
+
+        // Counts the warm-up of the cache too, which is part of its cost.
+        ray_counter counter(world);
+        const hittable& traced =
+            count_rays ? static_cast<const hittable&>(counter) : world;
+
+        std::unique_ptr<radiance_cache> cache;
+        uint64_t warmup_rays = 0;
+        if (cache_cell > 0)
+        {
+            cache = std::make_unique<radiance_cache>(cache_cell);
+            settings.cache = cache.get();
+            prime_radiance_cache(view, traced, settings, 16, pool);
+            warmup_rays = counter.count;
+        }
+
+        if (serve)
+        {
+            render_service service(world, pool, settings);
+            service.run(std::cin, std::cout);
+            return 0;
+        }
+
+        if (!views_path.empty())
+        {
+            std::ifstream in(views_path);
+            if (!in)
+                throw std::runtime_error("cannot open " + views_path);
+
+            auto views = read_views(in, settings);
+            auto start = std::chrono::steady_clock::now();
+            auto images = render_views(world, views, pool);
+
+            std::chrono::duration<double> elapsed =
+                std::chrono::steady_clock::now() - start;
+            std::cerr << "rendered " << views.size() << " views in "
+                      << elapsed.count() << "s\n";
+
+            for (size_t i = 0; i < images.size(); i++)
             {
-                double u = (col + random_double()) / (width - 1);
-                double v = (row + random_double()) / (height - 1);
-                ray r = cam.get_ray(u, v);
+                std::ofstream out(animation.output + "view_" +
+                                  std::to_string(i) + ".ppm");
+                write_ppm(out, images[i]);
+            }
+            return 0;
+        }
+
+        if (preview_levels > 1)
+            render_previews(world, settings, view, preview_levels,
+                            animation.output, pool);
+
+        camera cam = make_camera(view, settings);
 
-                pixel_color += ray_color(r, world, depth);
+        if (crop_given)
+        {
+            if (crop.x0 < 0 || crop.y0 < 0 || crop.x1 > settings.width ||
+                crop.y1 > settings.height || crop.x1 <= crop.x0 ||
+                crop.y1 <= crop.y0)
+                throw std::runtime_error("crop lies outside the frame");
+
+            framebuffer fb(crop);
+            render_area(cam, world, settings, 0, pool, fb);
+            image result = to_image(fb);
+
+            if (!composite_path.empty())
+            {
+                std::ifstream in(composite_path, std::ios::binary);
+                image base = read_ppm(in);
+                if (base.width != settings.width ||
+                    base.height != settings.height)
+                    throw std::runtime_error(composite_path +
+                                             " does not match --size");
+
+                paste(base, result, crop.x0, crop.y0);
+                result = base;
             }
 
-            screen[x] = pixel_color;
-        }
-    };
-
-    /*
-     *  Divide work between the workers; each worker gets to compute
-     *  (width * height) / thead_amount --- amount of pixels.
-     */
-    std::vector<color> screen(height * width);
-    std::vector<std::thread> threads;
-    const int thread_amount = 100;
-    constexpr double quotient = width * height / thread_amount;
-    int start = 0;
-    int end = 0;
-    for (int i = 0; i < thread_amount; i++)
-    {
-        start = i * quotient;
-        end = (i + 1) * quotient;
+            write_ppm(std::cout, result);
+            return 0;
+        }
 
-        threads.push_back(
-            std::thread(partial_render, start, end, std::ref(screen)));
-    }
+        if (!checkpoint_path.empty())
+        {
+            framebuffer fb = render_checkpointed(
+                cam, world, settings, view, pass_samples, checkpoint_path,
+                checkpoint_interval, resume, pool);
 
-    for (auto& t : threads)
-    {
-        if (t.joinable())
-            t.join();
-    }
+            // A stopped render is unfinished; only the checkpoint has it.
+            if (stop_requested)
+                return 128 + stop_requested;
 
-    for (const auto& c : screen)
+            write_ppm(std::cout, fb);
+            return 0;
+        }
+
+        if (time_budget > 0)
+        {
+            framebuffer fb(settings.width, settings.height);
+            render_within(cam, world, settings, time_budget, pass_samples,
+                          pool, fb);
+            std::cerr << "rendered " << fb.passes << " passes, "
+                      << fb.min_samples() << " to " << fb.max_samples()
+                      << " samples per pixel\n";
+            write_ppm(std::cout, fb);
+            return 0;
+        }
+
+        framebuffer fb = render(cam, traced, settings, pool);
+        write_ppm(std::cout, fb);
+
+        if (count_rays)
+        {
+            double samples = static_cast<double>(settings.width) *
+                             settings.height * settings.sample_amount;
+            std::cerr << counter.count << " rays traced, "
+                      << counter.count / samples << " per sample\n";
+            if (cache)
+                std::cerr << "of which " << warmup_rays
+                          << " warmed up the radiance cache\n";
+        }
+        if (memory_report)
+            write_memory_report(std::cerr, memory_usage());
+        if (cache)
+            std::cerr << cache->cells() << " radiance cache cells, "
+                      << cache->hits() << " of " << cache->lookups()
+                      << " lookups answered\n";
+        if (textures)
+            std::cerr << textures->loads() << " texture tile loads, "
+                      << textures->hits() << " cache hits, peak "
+                      << (textures->peak_bytes() >> 10) << " KiB resident\n";
+    }
+    catch (const std::exception& e)
     {
-        write_color(std::cout, c, sample_amount);
+        std::cerr << "error: " << e.what() << "\n";
+        return 1;
     }
 
     return 0;
-}
\ No newline at end of file
+}
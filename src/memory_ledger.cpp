@@ -0,0 +1,70 @@
+/*
+ * This file is part of Simple Ray Tracer.
+ * (https://github.com/ericwoude/ray-tracer)
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright © 2022 Eric van der Woude
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the “Software”), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "memory_ledger.h"
+
+#include <sys/resource.h>
+
+#include <cstdio>
+
+const char* category_name(memory_category c)
+{
+    static const char* names[memory_category_count] = {
+        "primitives", "materials", "acceleration", "framebuffer", "scratch"};
+
+    return names[static_cast<int>(c)];
+}
+
+static void write_row(std::ostream& out, const char* name, int64_t steady,
+                      int64_t peak)
+{
+    char line[80];
+    snprintf(line, sizeof(line), "%-14s %12.1f %12.1f\n", name,
+             steady / 1024.0, peak / 1024.0);
+    out << line;
+}
+
+void write_memory_report(std::ostream& out, const memory_ledger& ledger)
+{
+    char line[80];
+    snprintf(line, sizeof(line), "%-14s %12s %12s\n", "KiB", "steady",
+             "peak");
+    out << line;
+
+    for (int i = 0; i < memory_category_count; i++)
+    {
+        auto c = static_cast<memory_category>(i);
+        write_row(out, category_name(c), ledger.current(c), ledger.peak(c));
+    }
+    write_row(out, "total", ledger.current_total(), ledger.peak_total());
+
+    // Everything else: code, thread stacks, allocator overhead.
+    rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) == 0)
+        out << "peak resident size of the process: " << usage.ru_maxrss
+            << " KiB\n";
+}
@@ -0,0 +1,96 @@
+/*
+ * This file is part of Simple Ray Tracer.
+ * (https://github.com/ericwoude/ray-tracer)
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright © 2022 Eric van der Woude
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the “Software”), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "radiance_cache.h"
+
+#include "utility.h"
+
+radiance_cache::radiance_cache(double cell_size, int min_samples,
+                               int max_samples)
+    : inverse_size(1.0 / cell_size),
+      min_samples(min_samples),
+      max_samples(max_samples)
+{
+}
+
+uint64_t radiance_cache::key(const point3& p, const vec3& n) const
+{
+    int axis = fabs(n.x()) > fabs(n.y()) ? (fabs(n.x()) > fabs(n.z()) ? 0 : 2)
+                                         : (fabs(n.y()) > fabs(n.z()) ? 1 : 2);
+    uint64_t side = 2 * axis + (n[axis] < 0);
+
+    uint64_t h = side;
+    for (int i = 0; i < 3; i++)
+        h = hash_seed(h, static_cast<int64_t>(floor(p[i] * inverse_size)));
+
+    return h;
+}
+
+bool radiance_cache::lookup(const point3& p, const vec3& n,
+                            color& radiance) const
+{
+    lookup_count.fetch_add(1, std::memory_order_relaxed);
+
+    uint64_t k = key(p, n);
+    const shard& s = shards[k % shard_count];
+    std::lock_guard<std::mutex> lock(s.m);
+
+    auto it = s.cells.find(k);
+    if (it == s.cells.end() || it->second.count < min_samples)
+        return false;
+
+    radiance = it->second.sum / it->second.count;
+    hit_count.fetch_add(1, std::memory_order_relaxed);
+
+    return true;
+}
+
+void radiance_cache::add(const point3& p, const vec3& n, const color& radiance)
+{
+    uint64_t k = key(p, n);
+    shard& s = shards[k % shard_count];
+    std::lock_guard<std::mutex> lock(s.m);
+
+    cell& c = s.cells[k];
+    if (c.count >= max_samples)
+        c.sum *= (max_samples - 1.0) / max_samples;
+    else
+        c.count++;
+    c.sum += radiance;
+}
+
+size_t radiance_cache::cells() const
+{
+    size_t total = 0;
+    for (const auto& s : shards)
+    {
+        std::lock_guard<std::mutex> lock(s.m);
+        total += s.cells.size();
+    }
+
+    return total;
+}
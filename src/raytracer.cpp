@@ -0,0 +1,138 @@
+/*
+ * This file is part of Simple Ray Tracer.
+ * (https://github.com/ericwoude/ray-tracer)
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright © 2022 Eric van der Woude
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the “Software”), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "raytracer.h"
+
+#include <stdexcept>
+
+#include "scenes.h"
+
+void scene::build() { accel = std::make_shared<wide_bvh>(objects); }
+
+const hittable& scene::world() const
+{
+    if (!accel)
+        throw std::logic_error("scene::build() has not been called");
+
+    return *accel;
+}
+
+scene demo_scene(uint64_t seed)
+{
+    seed_random(seed);
+    scene s;
+
+    for (const auto& o : generate_world().objects)
+        s.add(o);
+    s.build();
+
+    return s;
+}
+
+void render_job::wait()
+{
+    std::unique_lock<std::mutex> lock(m);
+    cv.wait(lock, [this] { return finished == total; });
+
+    if (error)
+        std::rethrow_exception(error);
+}
+
+void render_job::fail(std::exception_ptr e)
+{
+    std::lock_guard<std::mutex> lock(m);
+    if (!error)
+        error = e;
+}
+
+void render_job::finish_tile(bool was_rendered)
+{
+    if (was_rendered)
+        rendered++;
+
+    {
+        std::lock_guard<std::mutex> lock(m);
+        finished++;
+    }
+    cv.notify_all();
+}
+
+renderer::renderer(unsigned int threads)
+    : own_pool(new thread_pool(threads)), pool(own_pool.get())
+{
+}
+
+renderer::renderer(thread_pool& p) : pool(&p) {}
+
+std::shared_ptr<render_job> renderer::render(const scene& world,
+                                             const camera_params& view,
+                                             const render_settings& s,
+                                             float* rgb, tile_callback on_tile)
+{
+    const hittable& accel = world.world();
+    auto tiles = morton_tiles({0, 0, s.width, s.height});
+    auto job = std::make_shared<render_job>(tiles.size());
+    auto cam = std::make_shared<camera>(make_camera(view, s));
+
+    for (const auto& t : tiles)
+    {
+        pool->submit([job, cam, &accel, s, t, rgb, on_tile] {
+            bool run = !job->cancelled;
+            if (run)
+            {
+                try
+                {
+                    // Each tile accumulates on its own, so no frame-sized
+                    // buffer besides the caller's is needed.
+                    framebuffer fb(t);
+                    render_tile(*cam, accel, s, t, 0, fb);
+
+                    fb.for_each_pixel([&](int x, int y) {
+                        color c =
+                            fb.sum(x, y) / std::max(fb.samples(x, y), 1);
+                        float* p = rgb + 3 * (y * s.width + x);
+                        p[0] = c.x();
+                        p[1] = c.y();
+                        p[2] = c.z();
+                    });
+
+                    if (on_tile)
+                        on_tile(t);
+                }
+                catch (...)
+                {
+                    job->fail(std::current_exception());
+                    run = false;
+                }
+            }
+
+            job->finish_tile(run);
+        });
+    }
+
+    return job;
+}
@@ -0,0 +1,169 @@
+/*
+ * This file is part of Simple Ray Tracer.
+ * (https://github.com/ericwoude/ray-tracer)
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright © 2022 Eric van der Woude
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the “Software”), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "scenes.h"
+
+#include <algorithm>
+
+#include "material.h"
+#include "paged_mesh.h"
+#include "sphere.h"
+
+using std::make_shared;
+
+hittable_list generate_world(std::shared_ptr<texture> globe)
+{
+    hittable_list world;
+    material_set materials;  // the glass spheres all share one material
+
+    auto ground_material =
+        materials.intern(make_shared<lambertian>(color(0.5, 0.5, 0.5)));
+    world.add(make_shared<sphere>(point3(0, -1000, 0), 1000, ground_material));
+
+    for (int a = -11; a < 11; a++)
+    {
+        for (int b = -11; b < 11; b++)
+        {
+            auto choose_mat = random_double();
+            point3 center(a + 0.9 * random_double(), 0.2,
+                          b + 0.9 * random_double());
+
+            if ((center - point3(4, 0.2, 0)).length() > 0.9)
+            {
+                std::shared_ptr<material> sphere_material;
+
+                if (choose_mat < 0.8)
+                {
+                    // diffuse
+                    auto albedo = color::random() * color::random();
+                    sphere_material =
+                        materials.intern(make_shared<lambertian>(albedo));
+                    world.add(
+                        make_shared<sphere>(center, 0.2, sphere_material));
+                }
+                else if (choose_mat < 0.95)
+                {
+                    // metal
+                    auto albedo = color::random(0.5, 1);
+                    auto fuzz = random_double(0, 0.5);
+                    sphere_material =
+                        materials.intern(make_shared<metal>(albedo, fuzz));
+                    world.add(
+                        make_shared<sphere>(center, 0.2, sphere_material));
+                }
+                else
+                {
+                    // glass
+                    sphere_material =
+                        materials.intern(make_shared<dielectric>(1.5));
+                    world.add(
+                        make_shared<sphere>(center, 0.2, sphere_material));
+                }
+            }
+        }
+    }
+
+    auto material1 = materials.intern(make_shared<dielectric>(1.5));
+    world.add(make_shared<sphere>(point3(0, 1, 0), 1.0, material1));
+
+    auto material2 = materials.intern(
+        globe ? make_shared<lambertian>(globe)
+              : make_shared<lambertian>(color(0.4, 0.2, 0.1)));
+    world.add(make_shared<sphere>(point3(-4, 1, 0), 1.0, material2));
+
+    auto material3 =
+        materials.intern(make_shared<metal>(color(0.7, 0.6, 0.5), 0.0));
+    world.add(make_shared<sphere>(point3(4, 1, 0), 1.0, material3));
+
+    return world;
+}
+
+std::vector<std::shared_ptr<material>> mesh_palette()
+{
+    return {make_shared<lambertian>(color(0.6, 0.3, 0.2)),
+            make_shared<lambertian>(color(0.2, 0.4, 0.6)),
+            make_shared<metal>(color(0.8, 0.8, 0.7), 0.2)};
+}
+
+/*
+ *  Streams a field of grid x grid pyramids to a chunk file, one chunk per
+ *  block of 8 x 8 pyramids, without holding the field in memory.
+ */
+void write_pyramid_field(const std::string& path, int grid)
+{
+    const int block = 8;
+    const double spacing = 1.0;
+    mesh_chunk_writer out(path);
+
+    for (int bz = 0; bz < grid; bz += block)
+    {
+        for (int bx = 0; bx < grid; bx += block)
+        {
+            for (int z = bz; z < std::min(bz + block, grid); z++)
+            {
+                for (int x = bx; x < std::min(bx + block, grid); x++)
+                {
+                    double cx = (x - grid / 2) * spacing;
+                    double cz = (z - grid / 2) * spacing;
+                    double r = 0.4 * spacing;
+                    point3 apex(cx, 0.3 + 0.7 * random_double(), cz);
+                    point3 c[4] = {point3(cx - r, 0, cz - r),
+                                   point3(cx + r, 0, cz - r),
+                                   point3(cx + r, 0, cz + r),
+                                   point3(cx - r, 0, cz + r)};
+                    uint32_t m = static_cast<uint32_t>(3 * random_double());
+
+                    for (int i = 0; i < 4; i++)
+                        out.add({c[i], c[(i + 1) % 4], apex, m});
+                }
+            }
+            out.end_chunk();
+        }
+    }
+
+    out.finish();
+}
+
+// The same world with its small spheres bouncing.
+animated_scene generate_animated_world(uint64_t seed)
+{
+    seed_random(seed);
+    hittable_list world = generate_world();
+    std::vector<animation_track> tracks;
+
+    for (const auto& o : world.objects)
+    {
+        auto s = std::dynamic_pointer_cast<sphere>(o);
+        if (s && s->radius < 0.5)
+        {
+            tracks.push_back({s, s->center, vec3(0, 0.5, 0),
+                              0.5 + random_double(), random_double()});
+        }
+    }
+
+    return animated_scene(world, tracks);
+}
@@ -0,0 +1,85 @@
+/*
+ * This file is part of Simple Ray Tracer.
+ * (https://github.com/ericwoude/ray-tracer)
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright © 2022 Eric van der Woude
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the “Software”), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "sphere.h"
+
+#include "material.h"
+#include "memory_ledger.h"
+
+bool sphere::hit(const ray& r, double t_min, double t_max,
+                 hit_record& rec) const
+{
+    vec3 oc = r.origin() - center;
+
+    double a = r.direction().length_squared();
+    double h = dot(oc, r.direction());
+    double c = oc.length_squared() - radius * radius;
+    double discriminant = h * h - a * c;
+
+    if (discriminant < 0)
+        return false;
+
+    double d_sqrt = sqrt(discriminant);
+    double root = (-h - d_sqrt) / a;
+    if (root < t_min || root > t_max)
+    {
+        root = (-h + d_sqrt) / a;
+        if (root < t_min || root > t_max)
+            return false;
+    }
+
+    rec.t = root;
+    rec.p = r.at(rec.t);
+    vec3 outward_normal = (rec.p - center) / radius;
+    rec.set_face_normal(r, outward_normal);
+    rec.mat_ptr = mat_ptr;
+
+    // Longitude and latitude; u runs once around the circumference.
+    double theta = acos(-outward_normal.y());
+    double phi = atan2(-outward_normal.z(), outward_normal.x()) + pi;
+    rec.u = phi / (2 * pi);
+    rec.v = theta / pi;
+    rec.uv_footprint = r.width_at(root) / (2 * pi * radius);
+
+    return true;
+}
+
+bool sphere::bounding_box(aabb& output_box) const
+{
+    vec3 r(radius, radius, radius);
+    output_box = aabb(center - r, center + r);
+
+    return true;
+}
+
+void sphere::footprint(scene_footprint& f) const
+{
+    if (f.add(this, memory_category::primitives,
+              sizeof(*this) + shared_block_bytes) &&
+        mat_ptr)
+        mat_ptr->footprint(f);
+}
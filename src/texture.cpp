@@ -0,0 +1,295 @@
+/*
+ * This file is part of Simple Ray Tracer.
+ * (https://github.com/ericwoude/ray-tracer)
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright © 2022 Eric van der Woude
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the “Software”), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "texture.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+#include "color.h"
+
+// Inverse of the gamma-2 encoding that to_byte applies.
+static double decode(unsigned char byte)
+{
+    static const std::vector<double> table = [] {
+        std::vector<double> t(256);
+        for (int i = 0; i < 256; i++)
+            t[i] = ((i + 0.5) / 256) * ((i + 0.5) / 256);
+        return t;
+    }();
+
+    return table[byte];
+}
+
+static uint64_t tile_key(int id, int level, int tile)
+{
+    return (static_cast<uint64_t>(id) << 40) |
+           (static_cast<uint64_t>(level) << 32) | tile;
+}
+
+void write_texture(const std::string& path, const image& img)
+{
+    if (img.width <= 0 || img.height <= 0)
+        throw std::runtime_error("cannot make a texture of an empty image");
+
+    // Averaging happens in linear space, so the mips keep the brightness.
+    std::vector<std::vector<color>> pixels(1);
+    std::vector<texture_level> table;
+    for (size_t i = 0; i < img.rgb.size(); i += 3)
+        pixels[0].push_back(color(decode(img.rgb[i]), decode(img.rgb[i + 1]),
+                                  decode(img.rgb[i + 2])));
+
+    int w = img.width, h = img.height;
+    while (true)
+    {
+        table.push_back({w, h, (w + texture_tile_size - 1) / texture_tile_size,
+                         (h + texture_tile_size - 1) / texture_tile_size, 0});
+        if (w == 1 && h == 1)
+            break;
+
+        int nw = std::max(w / 2, 1), nh = std::max(h / 2, 1);
+        const std::vector<color>& src = pixels.back();
+        std::vector<color> dst(nw * nh);
+
+        for (int y = 0; y < nh; y++)
+        {
+            for (int x = 0; x < nw; x++)
+            {
+                int x0 = std::min(2 * x, w - 1);
+                int x1 = std::min(2 * x + 1, w - 1);
+                int y0 = std::min(2 * y, h - 1);
+                int y1 = std::min(2 * y + 1, h - 1);
+                dst[y * nw + x] = 0.25 * (src[y0 * w + x0] + src[y0 * w + x1] +
+                                          src[y1 * w + x0] + src[y1 * w + x1]);
+            }
+        }
+
+        pixels.push_back(std::move(dst));
+        w = nw;
+        h = nh;
+    }
+
+    const size_t tile_bytes = 3 * texture_tile_size * texture_tile_size;
+    uint64_t offset =
+        sizeof(texture_file_header) + table.size() * sizeof(texture_level);
+    for (auto& l : table)
+    {
+        l.offset = offset;
+        offset += static_cast<uint64_t>(l.tiles_x) * l.tiles_y * tile_bytes;
+    }
+
+    texture_file_header header;
+    std::memcpy(header.magic, texture_file_magic, sizeof(header.magic));
+    header.width = img.width;
+    header.height = img.height;
+    header.levels = table.size();
+    header.tile_size = texture_tile_size;
+
+    std::ofstream out(path, std::ios::binary);
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char*>(table.data()),
+              table.size() * sizeof(texture_level));
+
+    std::vector<unsigned char> tile(tile_bytes);
+    for (size_t level = 0; level < table.size(); level++)
+    {
+        const texture_level& l = table[level];
+
+        for (int ty = 0; ty < l.tiles_y; ty++)
+        {
+            for (int tx = 0; tx < l.tiles_x; tx++)
+            {
+                std::fill(tile.begin(), tile.end(), 0);
+
+                for (int y = 0; y < texture_tile_size; y++)
+                {
+                    int py = ty * texture_tile_size + y;
+                    for (int x = 0; x < texture_tile_size; x++)
+                    {
+                        int px = tx * texture_tile_size + x;
+                        if (px >= l.width || py >= l.height)
+                            continue;
+
+                        const color& c = pixels[level][py * l.width + px];
+                        unsigned char* p =
+                            &tile[3 * (y * texture_tile_size + x)];
+                        p[0] = to_byte(c.x(), 1);
+                        p[1] = to_byte(c.y(), 1);
+                        p[2] = to_byte(c.z(), 1);
+                    }
+                }
+
+                out.write(reinterpret_cast<const char*>(tile.data()),
+                          tile.size());
+            }
+        }
+    }
+
+    if (!out)
+        throw std::runtime_error("cannot write " + path);
+}
+
+texture_cache::texture_cache(size_t budget_bytes)
+    : cache(budget_bytes, memory_category::materials)
+{
+    static std::atomic<uint64_t> next_serial(1);
+    serial = next_serial++;
+}
+
+texture_cache::~texture_cache()
+{
+    for (const auto& f : files)
+        close(f.fd);
+}
+
+int texture_cache::open(const std::string& path)
+{
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        throw std::runtime_error("cannot open " + path);
+
+    texture_file_header header;
+    file f{fd, {}};
+
+    if (pread(fd, &header, sizeof(header), 0) != sizeof(header) ||
+        std::memcmp(header.magic, texture_file_magic, sizeof(header.magic)) ||
+        header.tile_size != texture_tile_size || header.levels <= 0)
+    {
+        close(fd);
+        throw std::runtime_error(path + " is not a texture file");
+    }
+
+    f.levels.resize(header.levels);
+    ssize_t size = f.levels.size() * sizeof(texture_level);
+    if (pread(fd, f.levels.data(), size, sizeof(header)) != size)
+    {
+        close(fd);
+        throw std::runtime_error(path + " is truncated");
+    }
+
+    files.push_back(f);
+
+    return files.size() - 1;
+}
+
+color texture_cache::texel(int id, int level, int x, int y)
+{
+    const texture_level& l = files[id].levels[level];
+    x %= l.width;
+    y %= l.height;
+    if (x < 0)
+        x += l.width;
+    if (y < 0)
+        y += l.height;
+
+    // Neighbouring lookups mostly land in the tile of the previous one, so
+    // each thread keeps that tile without going through the shared cache.
+    struct last_tile
+    {
+        uint64_t serial = 0;
+        uint64_t key = 0;
+        std::shared_ptr<const tile_data> data;
+    };
+    thread_local last_tile memo;
+
+    int tile = (y / texture_tile_size) * l.tiles_x + x / texture_tile_size;
+    uint64_t key = tile_key(id, level, tile);
+
+    if (!memo.data || memo.serial != serial || memo.key != key)
+    {
+        memo.data = fetch(id, level, tile);
+        memo.serial = serial;
+        memo.key = key;
+    }
+
+    const unsigned char* p =
+        memo.data->data() +
+        3 * ((y % texture_tile_size) * texture_tile_size +
+             x % texture_tile_size);
+
+    return color(decode(p[0]), decode(p[1]), decode(p[2]));
+}
+
+std::shared_ptr<const texture_cache::tile_data> texture_cache::fetch(
+    int id, int level, int tile)
+{
+    return cache.get(tile_key(id, level, tile), [&](size_t& size) {
+        const file& f = files[id];
+        size = 3 * texture_tile_size * texture_tile_size;
+        auto data = std::make_shared<tile_data>(size);
+        off_t offset = f.levels[level].offset + tile * size;
+
+        if (pread(f.fd, data->data(), size, offset) !=
+            static_cast<ssize_t>(size))
+            throw std::runtime_error("cannot read texture tile");
+
+        return data;
+    });
+}
+
+color image_texture::value(double u, double v, double footprint) const
+{
+    const std::vector<texture_level>& levels = cache->levels(id);
+    int last = levels.size() - 1;
+
+    // Level 0 when a footprint covers at most a texel, one level up for
+    // every doubling beyond that.
+    double texels =
+        footprint * scale * std::max(levels[0].width, levels[0].height);
+    double lod = texels > 1 ? std::min(log2(texels), double(last)) : 0;
+    int level = static_cast<int>(lod);
+    double blend = lod - level;
+
+    color c = bilinear(level, u * scale, v * scale);
+    if (blend > 0 && level < last)
+        c = (1 - blend) * c + blend * bilinear(level + 1, u * scale, v * scale);
+
+    return c;
+}
+
+color image_texture::bilinear(int level, double u, double v) const
+{
+    const texture_level& l = cache->levels(id)[level];
+
+    // Texel centers sit at half-integers, and v runs up the image.
+    double x = u * l.width - 0.5;
+    double y = (1 - v) * l.height - 0.5;
+    double fx = floor(x), fy = floor(y);
+    int x0 = static_cast<int>(fx), y0 = static_cast<int>(fy);
+    double tx = x - fx, ty = y - fy;
+
+    return (1 - tx) * (1 - ty) * cache->texel(id, level, x0, y0) +
+           tx * (1 - ty) * cache->texel(id, level, x0 + 1, y0) +
+           (1 - tx) * ty * cache->texel(id, level, x0, y0 + 1) +
+           tx * ty * cache->texel(id, level, x0 + 1, y0 + 1);
+}
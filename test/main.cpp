@@ -0,0 +1,86 @@
+/*
+ * This file is part of Simple Ray Tracer.
+ * (https://github.com/ericwoude/ray-tracer)
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright © 2022 Eric van der Woude
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the “Software”), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <string>
+
+#include "regression.h"
+#include "thread_pool.h"
+
+const char* usage =
+    "usage: raytracer_regress <dir> [options]\n"
+    "  compares test renders with the reference images and the speed\n"
+    "  baseline in dir\n"
+    "  --update-references     rewrite the references in dir\n"
+    "  --tolerance <rms>       allowed RMS image difference (default 2)\n"
+    "  --slowdown <fraction>   allowed loss of rays per second (default .25)\n"
+    "  --images-only           compare only the images, without timing\n";
+
+int main(int argc, char* argv[])
+{
+    regression_settings regression;
+
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+
+        if (arg == "--update-references")
+            regression.update = true;
+        else if (arg == "--tolerance" && i + 1 < argc)
+            regression.tolerance = std::atof(argv[++i]);
+        else if (arg == "--slowdown" && i + 1 < argc)
+            regression.slowdown = std::atof(argv[++i]);
+        else if (arg == "--images-only")
+            regression.timing = false;
+        else if (arg[0] != '-' && regression.directory.empty())
+            regression.directory = arg;
+        else
+        {
+            std::cerr << usage;
+            return 1;
+        }
+    }
+
+    if (regression.directory.empty())
+    {
+        std::cerr << usage;
+        return 1;
+    }
+
+    try
+    {
+        thread_pool pool;
+        return run_regression(regression, pool, std::cout) > 0 ? 1 : 0;
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "error: " << e.what() << "\n";
+        return 1;
+    }
+}
@@ -0,0 +1,278 @@
+/*
+ * This file is part of Simple Ray Tracer.
+ * (https://github.com/ericwoude/ray-tracer)
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright © 2022 Eric van der Woude
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the “Software”), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "regression.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <map>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+#include "image.h"
+#include "material.h"
+#include "paged_mesh.h"
+#include "ray_counter.h"
+#include "render.h"
+#include "scenes.h"
+#include "sphere.h"
+#include "texture.h"
+#include "triangle.h"
+#include "wide_bvh.h"
+
+// Set by the build; speed is only comparable between builds of one type,
+// so each keeps its own baseline.
+#ifndef RAYTRACER_BUILD_TYPE
+#define RAYTRACER_BUILD_TYPE "unknown"
+#endif
+
+using std::make_shared;
+
+struct regression_case
+{
+    std::string name;
+    render_settings settings;
+
+    // Builds the world after the generator has been seeded. Files the
+    // world needs are written to the given directory.
+    std::function<std::shared_ptr<hittable>(const std::string&)> build;
+};
+
+// Loose triangles of the three mesh materials above the ground sphere.
+static std::shared_ptr<hittable> triangle_world(const std::string&)
+{
+    hittable_list world;
+    auto palette = mesh_palette();
+
+    world.add(make_shared<sphere>(
+        point3(0, -1000, 0), 1000,
+        make_shared<lambertian>(color(0.5, 0.5, 0.5))));
+
+    for (int i = 0; i < 300; i++)
+    {
+        point3 center(random_double(-4, 4), random_double(0, 2),
+                      random_double(-4, 4));
+        world.add(make_shared<triangle>(
+            center + vec3::random(-0.4, 0.4), center + vec3::random(-0.4, 0.4),
+            center + vec3::random(-0.4, 0.4), palette[i % palette.size()]));
+    }
+
+    return make_shared<wide_bvh>(world);
+}
+
+// The book scene with a procedural checker texture around the big diffuse
+// sphere, read through a cache small enough to evict.
+static std::shared_ptr<hittable> textured_world(const std::string& directory)
+{
+    const unsigned char red[3] = {230, 60, 40}, cream[3] = {240, 230, 200};
+    image checker;
+    checker.width = 256;
+    checker.height = 128;
+    for (int y = 0; y < checker.height; y++)
+    {
+        for (int x = 0; x < checker.width; x++)
+        {
+            const unsigned char* c = (x / 16 + y / 16) % 2 ? red : cream;
+            checker.rgb.insert(checker.rgb.end(), c, c + 3);
+        }
+    }
+
+    std::string path = directory + "/checker.rtx";
+    write_texture(path, checker);
+
+    auto cache = make_shared<texture_cache>(64 << 10);
+    return make_shared<wide_bvh>(
+        generate_world(make_shared<image_texture>(cache, path)));
+}
+
+// The pyramid field paged from disk, traced a bounce at a time.
+static std::shared_ptr<hittable> mesh_world(const std::string& directory)
+{
+    std::string path = directory + "/pyramids.mesh";
+    write_pyramid_field(path, 24);
+
+    auto world = make_shared<hittable_list>(
+        make_shared<paged_mesh>(path, 1 << 20, mesh_palette()));
+    world->add(make_shared<sphere>(
+        point3(0, -1000, 0), 1000,
+        make_shared<lambertian>(color(0.5, 0.5, 0.5))));
+
+    return world;
+}
+
+static std::vector<regression_case> regression_cases()
+{
+    render_settings s;
+    s.width = 96;
+    s.height = 54;
+    s.sample_amount = 8;
+
+    render_settings wavefront = s;
+    wavefront.wavefront = true;
+
+    render_settings paged = wavefront;
+    paged.sample_amount = 2;
+
+    auto spheres = [](const std::string&) -> std::shared_ptr<hittable> {
+        return make_shared<wide_bvh>(generate_world());
+    };
+
+    return {{"spheres", s, spheres},
+            {"spheres_wavefront", wavefront, spheres},
+            {"triangles", s, triangle_world},
+            {"textured", s, textured_world},
+            {"mesh", paged, mesh_world}};
+}
+
+static std::map<std::string, double> read_baseline(const std::string& path)
+{
+    std::map<std::string, double> baseline;
+    std::ifstream in(path);
+    std::string name;
+    double rays_per_second;
+
+    while (in >> name >> rays_per_second)
+        baseline[name] = rays_per_second;
+
+    return baseline;
+}
+
+int run_regression(const regression_settings& s, thread_pool& pool,
+                   std::ostream& log)
+{
+    std::string baseline_path =
+        s.directory + "/baseline_" RAYTRACER_BUILD_TYPE ".txt";
+    std::map<std::string, double> baseline = read_baseline(baseline_path);
+    bool recorded = false;
+    int failures = 0;
+    char line[160];
+
+    for (const auto& c : regression_cases())
+    {
+        seed_random(c.settings.seed);
+        auto world = c.build(s.directory);
+        camera cam = make_camera(camera_params(), c.settings);
+
+        // The counted render gives the image; the timed ones trace the
+        // same rays without the counter in the way.
+        ray_counter counter(*world);
+        image result = to_image(render(cam, counter, c.settings, pool));
+
+        double fastest = infinity;
+        for (int i = 0; s.timing && i < std::max(s.repeats, 1); i++)
+        {
+            auto start = std::chrono::steady_clock::now();
+            render(cam, *world, c.settings, pool);
+            std::chrono::duration<double> elapsed =
+                std::chrono::steady_clock::now() - start;
+            fastest = std::min(fastest, elapsed.count());
+        }
+        double rays_per_second = counter.count / fastest;
+
+        std::string reference_path = s.directory + "/" + c.name + ".ppm";
+        if (s.update)
+        {
+            std::ofstream out(reference_path);
+            write_ppm(out, result);
+            if (!out)
+                throw std::runtime_error("cannot write " + reference_path);
+
+            snprintf(line, sizeof(line), "%-18s written", c.name.c_str());
+            log << line;
+            if (s.timing)
+            {
+                baseline[c.name] = rays_per_second;
+                snprintf(line, sizeof(line), ", %.3fM rays/s",
+                         rays_per_second / 1e6);
+                log << line;
+            }
+            log << "\n";
+            continue;
+        }
+
+        std::ifstream in(reference_path, std::ios::binary);
+        if (!in)
+        {
+            log << c.name << ": no reference at " << reference_path << "\n";
+            failures++;
+            continue;
+        }
+
+        image reference = read_ppm(in);
+        double difference = rms_difference(result, reference);
+        double blurred = rms_difference(result, reference, 2);
+        // Filtering averages noise away, so what remains is held to a
+        // tighter bound.
+        bool failed = difference > s.tolerance || blurred > s.tolerance / 2;
+
+        snprintf(line, sizeof(line), "%-18s rms %.2f (blurred %.2f)",
+                 c.name.c_str(), difference, blurred);
+        log << line;
+        if (s.timing)
+        {
+            snprintf(line, sizeof(line), ", %.3fM rays/s",
+                     rays_per_second / 1e6);
+            log << line;
+        }
+
+        auto known = baseline.find(c.name);
+        if (s.timing && known == baseline.end())
+        {
+            // The first timed run on a machine sets its baseline.
+            baseline[c.name] = rays_per_second;
+            recorded = true;
+            log << " (baseline recorded)";
+        }
+        else if (s.timing)
+        {
+            double change = rays_per_second / known->second - 1;
+            snprintf(line, sizeof(line), " (baseline %.3fM, %+.1f%%)",
+                     known->second / 1e6, 100 * change);
+            log << line;
+            failed = failed || change < -s.slowdown;
+        }
+
+        log << (failed ? "  FAILED\n" : "  ok\n");
+        failures += failed;
+    }
+
+    // Without timing the old baseline stays as it was.
+    if (s.timing && (s.update || recorded))
+    {
+        std::ofstream out(baseline_path);
+        for (const auto& b : baseline)
+            out << b.first << " " << b.second << "\n";
+        if (!out)
+            throw std::runtime_error("cannot write " + baseline_path);
+    }
+
+    return failures;
+}
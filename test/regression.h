@@ -0,0 +1,59 @@
+/*
+ * This file is part of Simple Ray Tracer.
+ * (https://github.com/ericwoude/ray-tracer)
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright © 2022 Eric van der Woude
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the “Software”), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef REGRESSION_H
+#define REGRESSION_H
+
+#include <iostream>
+#include <string>
+
+#include "thread_pool.h"
+
+/*
+ *  Golden image and speed checks. A fixed set of small scenes is rendered
+ *  with fixed seeds; the images are compared with reference PPMs and the
+ *  ray throughput with a baseline, both stored in one directory. Speed
+ *  depends on the machine and the build type, so the baseline is not
+ *  shared: the first timed run writes baseline_<build type>.txt, and later
+ *  runs of that build compare with it.
+ */
+struct regression_settings
+{
+    std::string directory;
+    bool update = false;     // rewrite the references instead
+    double tolerance = 2.0;  // largest allowed RMS difference
+    double slowdown = 0.25;  // largest allowed loss of rays per second
+    int repeats = 5;         // timed renders, the fastest one counts
+    bool timing = true;      // time the cases, compare with the baseline
+};
+
+// Runs every case, writes a line per case to log and returns the amount
+// of failed cases.
+int run_regression(const regression_settings& s, thread_pool& pool,
+                   std::ostream& log);
+
+#endif  // REGRESSION_H
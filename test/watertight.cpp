@@ -0,0 +1,108 @@
+/*
+ * This file is part of Simple Ray Tracer.
+ * (https://github.com/ericwoude/ray-tracer)
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright © 2022 Eric van der Woude
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the “Software”), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED “AS IS”, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <iostream>
+#include <memory>
+#include <vector>
+
+#include "hittable_list.h"
+#include "triangle.h"
+#include "utility.h"
+
+/*
+ *  Checks that rays cannot slip between triangles that share an edge. A
+ *  bumpy grid of triangles is shot at its interior vertices, edges and
+ *  diagonals, the places where neighbours meet, from random points above
+ *  it. Every ray has to hit some triangle.
+ */
+
+using std::make_shared;
+
+const int grid = 24;  // quads per side, each split along a diagonal
+
+int main()
+{
+    seed_random(34);
+
+    std::vector<point3> heights((grid + 1) * (grid + 1));
+    for (int y = 0; y <= grid; y++)
+        for (int x = 0; x <= grid; x++)
+            heights[y * (grid + 1) + x] =
+                point3(x * 0.37, y * 0.37, random_double(-0.1, 0.1));
+
+    auto vertex = [&](int x, int y) { return heights[y * (grid + 1) + x]; };
+
+    hittable_list plane;
+    for (int y = 0; y < grid; y++)
+    {
+        for (int x = 0; x < grid; x++)
+        {
+            point3 a = vertex(x, y), b = vertex(x + 1, y),
+                   c = vertex(x + 1, y + 1), d = vertex(x, y + 1);
+            plane.add(make_shared<triangle>(a, b, c, nullptr));
+            plane.add(make_shared<triangle>(a, c, d, nullptr));
+        }
+    }
+
+    // Aim points where two or more triangles meet, away from the border.
+    std::vector<point3> targets;
+    for (int y = 1; y < grid; y++)
+    {
+        for (int x = 1; x < grid; x++)
+        {
+            double s = random_double();
+            targets.push_back(vertex(x, y));
+            targets.push_back(vertex(x, y) +
+                              s * (vertex(x + 1, y + 1) - vertex(x, y)));
+            targets.push_back(vertex(x, y) +
+                              s * (vertex(x + 1, y) - vertex(x, y)));
+            targets.push_back(vertex(x, y) +
+                              s * (vertex(x, y + 1) - vertex(x, y)));
+        }
+    }
+
+    int rays = 0, misses = 0;
+    for (const auto& target : targets)
+    {
+        for (int i = 0; i < 4; i++)
+        {
+            vec3 away(random_double(-1, 1), random_double(-1, 1),
+                      random_double(0.2, 1));
+            point3 origin = target + random_double(1, 10) * away;
+
+            hit_record rec;
+            rays++;
+            if (!plane.hit(ray(origin, target - origin), 0.001, infinity,
+                           rec))
+                misses++;
+        }
+    }
+
+    std::cout << misses << " of " << rays
+              << " rays slipped between triangles\n";
+    return misses > 0 ? 1 : 0;
+}